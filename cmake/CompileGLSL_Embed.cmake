@@ -0,0 +1,28 @@
+include(${CMAKE_CURRENT_LIST_DIR}/CompileGLSL_Lib.cmake)
+
+
+function(CompileGLSL_Embed inShaderOutputPath inShaderEmbeddingOutputName inSpirvBinaryFiles)
+    CompileGLSL_EmbedSpirvBinaries(
+        "${inSpirvBinaryFiles}"
+        "${inShaderOutputPath}"
+        "${inShaderEmbeddingOutputName}"
+        GLSL_SPIRV_BINARY_EMBEDDING_FILE
+    )
+endfunction()
+
+
+if(${CMAKE_ARGC} LESS 6)
+    message(FATAL_ERROR "Usage: cmake -P CompileGLSL_Embed.cmake <inShaderOutputPath> <inShaderEmbeddingOutputName> <inSpirvBinaryFile>...")
+endif()
+
+set(inShaderOutputPath "${CMAKE_ARGV3}")
+set(inShaderEmbeddingOutputName "${CMAKE_ARGV4}")
+
+# Every argument after the embedding file name is a SPIR-V binary to embed.
+set(inSpirvBinaryFiles)
+math(EXPR lastArgumentIndex "${CMAKE_ARGC} - 1")
+foreach(argumentIndex RANGE 5 ${lastArgumentIndex})
+    list(APPEND inSpirvBinaryFiles "${CMAKE_ARGV${argumentIndex}}")
+endforeach()
+
+CompileGLSL_Embed("${inShaderOutputPath}" "${inShaderEmbeddingOutputName}" "${inSpirvBinaryFiles}")
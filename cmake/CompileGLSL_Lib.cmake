@@ -36,15 +36,15 @@ function(CompileGLSL_GetShaderStage inShaderFile outShaderStage)
     set(${outShaderStage} "${shaderStage}" PARENT_SCOPE)
 endfunction()
 
-function(CompileGLSL_GetCompileOptions GLSL_COMPILER_COMMAND inShaderSourceFile inSpirvBinaryFile inShaderStage outCompileOptions)
+function(CompileGLSL_GetCompileOptions GLSL_COMPILER_COMMAND inShaderSourceFile inSpirvBinaryFile inShaderStage inDependencyFile outCompileOptions)
     set(glslCompilerName)
     get_filename_component(glslCompilerName "${GLSL_COMPILER_COMMAND}" NAME)
 
     set(compileOptions)
     if (${glslCompilerName} STREQUAL "glslc")
-        list(APPEND compileOptions -fshader-stage=${inShaderStage} -o "${inSpirvBinaryFile}" "${inShaderSourceFile}")
+        list(APPEND compileOptions -fshader-stage=${inShaderStage} -MD -MF "${inDependencyFile}" -o "${inSpirvBinaryFile}" "${inShaderSourceFile}")
     elseif (${glslCompilerName} STREQUAL "glslangValidator")
-        list(APPEND compileOptions -V "${inShaderSourceFile}" -o "${inSpirvBinaryFile}")
+        list(APPEND compileOptions -V --depfile "${inDependencyFile}" "${inShaderSourceFile}" -o "${inSpirvBinaryFile}")
     else()
         message(FATAL_ERROR
             "Unsupported compiler. The supported compilers are `glslc` and `glslangValidator`. "
@@ -55,40 +55,39 @@ function(CompileGLSL_GetCompileOptions GLSL_COMPILER_COMMAND inShaderSourceFile
     set(${outCompileOptions} "${compileOptions}" PARENT_SCOPE)
 endfunction()
 
-function(CompileGLSL_CompileShader GLSL_COMPILER_COMMAND inShaderSourceFile inSpirvBinaryOutputPath outSpirvBinaryOutputFile)
+#[[
+Each shader gets a build rule of its own, so the build tool only recompiles the shaders whose source, 
+or one of the files it includes, changed since the last build, and runs independent shader compiles in
+parallel. The compiler writes the included files into a depfile, which the build tool picks up.
+]]
+function(CompileGLSL_AddCompileCommand GLSL_COMPILER_COMMAND inShaderSourceFile inSpirvBinaryOutputPath outSpirvBinaryOutputFile)
     get_filename_component(fileName "${inShaderSourceFile}" NAME)
     set(spirvOutputFile "${inSpirvBinaryOutputPath}/${fileName}.spv")
+    set(dependencyFile "${spirvOutputFile}.d")
 
     set(shaderStage)
     CompileGLSL_GetShaderStage("${inShaderSourceFile}" shaderStage)
 
     set(compileOptions)
-    CompileGLSL_GetCompileOptions("${GLSL_COMPILER_COMMAND}" "${inShaderSourceFile}" "${spirvOutputFile}" "${shaderStage}" compileOptions)
-
-    list(APPEND fullCommand "${GLSL_COMPILER_COMMAND}" "${compileOptions}")
-
-    message(STATUS "Compiling shader")
-    message(STATUS "Input: `${fileName}`")
-    message(STATUS "Output: `${spirvOutputFile}`")
-    message(STATUS "Full compiler command: `${fullCommand}`")
-    execute_process(COMMAND ${fullCommand} RESULT_VARIABLE result)
-    if(result EQUAL 0)
-        message(STATUS "Compiling shader complete")
-    else()
-        message(FATAL_ERROR "Shader compilation failed with result `${result}`")
-    endif()
+    CompileGLSL_GetCompileOptions("${GLSL_COMPILER_COMMAND}" "${inShaderSourceFile}" "${spirvOutputFile}" "${shaderStage}" "${dependencyFile}" compileOptions)
+
+    add_custom_command(
+        OUTPUT "${spirvOutputFile}"
+        COMMAND "${GLSL_COMPILER_COMMAND}" ${compileOptions}
+        DEPENDS "${inShaderSourceFile}"
+        DEPFILE "${dependencyFile}"
+        COMMENT "Compiling GLSL shader `${fileName}`"
+        VERBATIM
+    )
 
     set(${outSpirvBinaryOutputFile} "${spirvOutputFile}" PARENT_SCOPE)
 endfunction()
 
-function(CompileGLSL_CompileShaders GLSL_COMPILER_COMMAND inShaderSourceFiles inSpirvBinaryOutputPath outSpirvBinaryFiles)
+function(CompileGLSL_AddCompileCommands GLSL_COMPILER_COMMAND inShaderSourceFiles inSpirvBinaryOutputPath outSpirvBinaryFiles)
     list(APPEND spirvBinaryFiles)
     foreach(shaderSourceFile IN LISTS inShaderSourceFiles)
-        get_filename_component(fileName "${shaderSourceFile}" NAME)
-        set(spirvOutputFile "${inSpirvBinaryOutputPath}/${fileName}.spv")
-
         set(spirvOutputFile)
-        CompileGLSL_CompileShader("${GLSL_COMPILER_COMMAND}" "${shaderSourceFile}" "${inSpirvBinaryOutputPath}" spirvOutputFile)
+        CompileGLSL_AddCompileCommand("${GLSL_COMPILER_COMMAND}" "${shaderSourceFile}" "${inSpirvBinaryOutputPath}" spirvOutputFile)
 
         list(APPEND spirvBinaryFiles "${spirvOutputFile}")
     endforeach()
@@ -116,28 +115,34 @@ function(CompileGLSL_EmbedShader_GenerateEmbeddingName inSpirvBinaryFileName out
     set(${outSpirvBinaryEmbeddingName} "${spirvBinaryEmbeddingName}" PARENT_SCOPE)
 endfunction()
 
-function(CompileGLSL_FormatSpirvBinaryToOctets inInputFile inOctetsPerLine outFormattedOctets outOctetsWritten)
+function(CompileGLSL_FormatSpirvBinaryToWords inInputFile inWordsPerLine outFormattedWords outWordsWritten)
     set(formattedData "")
     set(currentLine "")
     set(count 0)
-    set(octetsWritten 0)
+    set(wordsWritten 0)
 
-    # Process each byte
+    # SPIR-V is a stream of little-endian 32-bit words, which take up eight hex digits each.
     string(LENGTH "${inInputFile}" binaryLength)
-    math(EXPR lastIndex "${binaryLength} - 1")
-    foreach(index RANGE 0 ${lastIndex} 2)
-        string(SUBSTRING "${inInputFile}" ${index} 2 byte)
-        string(APPEND currentLine "0x${byte}")
-        math(EXPR count "${count} + 1")
-        math(EXPR octetsWritten "${octetsWritten} + 1")
+    math(EXPR remainder "${binaryLength} % 8")
+    if(binaryLength EQUAL 0 OR NOT remainder EQUAL 0)
+        message(FATAL_ERROR "Expected a SPIR-V binary made up of whole 32-bit words.")
+    endif()
 
-        # Add a comma if this is not the last line of the file.
-        if(NOT index EQUAL ${lastIndex})
-            string(APPEND currentLine ",")
-        endif()
+    math(EXPR lastIndex "${binaryLength} - 8")
+    foreach(index RANGE 0 ${lastIndex} 8)
+        math(EXPR index1 "${index} + 2")
+        math(EXPR index2 "${index} + 4")
+        math(EXPR index3 "${index} + 6")
+        string(SUBSTRING "${inInputFile}" ${index} 2 byte0)
+        string(SUBSTRING "${inInputFile}" ${index1} 2 byte1)
+        string(SUBSTRING "${inInputFile}" ${index2} 2 byte2)
+        string(SUBSTRING "${inInputFile}" ${index3} 2 byte3)
+        string(APPEND currentLine "0x${byte3}${byte2}${byte1}${byte0},")
+        math(EXPR count "${count} + 1")
+        math(EXPR wordsWritten "${wordsWritten} + 1")
 
-        # Start a new line if we've reached inOctetsPerLine.
-        if(count EQUAL inOctetsPerLine)
+        # Start a new line if we've reached inWordsPerLine.
+        if(count EQUAL inWordsPerLine)
             string(APPEND formattedData "${currentLine}\n")
             set(currentLine "")
             set(count 0)
@@ -150,8 +155,8 @@ function(CompileGLSL_FormatSpirvBinaryToOctets inInputFile inOctetsPerLine outFo
         string(APPEND formattedData "${currentLine}\n")
     endif()
     
-    set(${outFormattedOctets} "${formattedData}" PARENT_SCOPE)
-    set(${outOctetsWritten} "${octetsWritten}" PARENT_SCOPE)
+    set(${outFormattedWords} "${formattedData}" PARENT_SCOPE)
+    set(${outWordsWritten} "${wordsWritten}" PARENT_SCOPE)
 endfunction()
 
 function(CompileGLSL_EmbedShader inShaderFileName inSpirvBinaryFileName inSpirvBinaryFileData outSpirvBinaryEmbeddingData)
@@ -161,21 +166,23 @@ function(CompileGLSL_EmbedShader inShaderFileName inSpirvBinaryFileName inSpirvB
     string(APPEND arrayName "")
     CompileGLSL_EmbedShader_GenerateEmbeddingName("${inSpirvBinaryFileName}" arrayName)
 
-    set(formattedOctets "")
-    set(octetsWritten 0)
-    CompileGLSL_FormatSpirvBinaryToOctets("${inSpirvBinaryFileData}" 12 formattedOctets octetsWritten)
+    set(formattedWords "")
+    set(wordsWritten 0)
+    CompileGLSL_FormatSpirvBinaryToWords("${inSpirvBinaryFileData}" 8 formattedWords wordsWritten)
     
-    string(REGEX REPLACE "^0x" "    0x" formattedOctets "${formattedOctets}")
-    string(REGEX REPLACE ",\n0x" ",\n    0x" formattedOctets "${formattedOctets}")
+    string(REGEX REPLACE "^0x" "    0x" formattedWords "${formattedWords}")
+    string(REGEX REPLACE "\n0x" "\n    0x" formattedWords "${formattedWords}")
     
-    math(EXPR arraySize "${octetsWritten}")
+    math(EXPR arraySize "${wordsWritten}")
 
+    # The binary is embedded as an array of words rather than bytes, so that it is aligned the way 
+    # `vkCreateShaderModule` expects, and can be handed to it in place.
     string(APPEND combinedContent "// Shader: `${inShaderFileName}`\n")
     string(APPEND combinedContent "// SPIR-V Binary: `${inSpirvBinaryFileName}`\n")
-    string(APPEND combinedContent "const std::string ${shaderName} = std::string { \"${inShaderFileName}\" };\n")
-    string(APPEND combinedContent "const std::array<uint8_t, ${arraySize}> ${arrayName} = std::array<uint8_t, ${arraySize}> {")
+    string(APPEND combinedContent "constexpr std::string_view ${shaderName} = std::string_view { \"${inShaderFileName}\" };\n")
+    string(APPEND combinedContent "constexpr std::array<uint32_t, ${arraySize}> ${arrayName} = std::array<uint32_t, ${arraySize}> {")
     string(APPEND combinedContent "\n")
-    string(APPEND combinedContent "${formattedOctets}")
+    string(APPEND combinedContent "${formattedWords}")
     string(APPEND combinedContent "};")
 
     set(${outSpirvBinaryEmbeddingData} "${combinedContent}" PARENT_SCOPE)
@@ -229,31 +236,36 @@ function(CompileGLSL_CreateEmbeddingFile inSpirvEmbedding inFinalShaderEmbedding
     string(APPEND combinedContent "#define ${finalOutputIncludeGuardName}\n")
     string(APPEND combinedContent "\n")
     string(APPEND combinedContent "#include <array>\n")
-    string(APPEND combinedContent "#include <string>\n")
+    string(APPEND combinedContent "#include <cstdint>\n")
+    string(APPEND combinedContent "#include <string_view>\n")
     string(APPEND combinedContent "\n")
     string(APPEND combinedContent "${inSpirvEmbedding}")
     string(APPEND combinedContent "\n")
     string(APPEND combinedContent "#endif // ${finalOutputIncludeGuardName}")
     string(APPEND combinedContent "\n")
 
-    file(WRITE "${finalOutputFile}" "${combinedContent}")
+    # Only touch the embedding file when its contents change, so that rebuilding a shader into the same
+    # SPIR-V does not recompile the code that includes it.
+    file(WRITE "${finalOutputFile}.tmp" "${combinedContent}")
+    file(COPY_FILE "${finalOutputFile}.tmp" "${finalOutputFile}" ONLY_IF_DIFFERENT)
+    file(REMOVE "${finalOutputFile}.tmp")
 
     set(${outFinalShaderEmbeddingFile} "${finalOutputFile}" PARENT_SCOPE)
 endfunction()
 
-function(CompileGLSL_BuildShaders GLSL_COMPILER_COMMAND inShaderSourceFiles inFinalShaderEmbeddingOutputPath inFinalShaderEmbeddingFileName outFinalShaderEmbeddingFile)
-    CompileGLSL_CompileShaders(
-        "${GLSL_COMPILER_COMMAND}"
-        "${inShaderSourceFiles}"
-        "${inFinalShaderEmbeddingOutputPath}"
-        spirvBinaryFiles
-    )
+function(CompileGLSL_EmbedSpirvBinaries inSpirvBinaryFiles inFinalShaderEmbeddingOutputPath inFinalShaderEmbeddingFileName outFinalShaderEmbeddingFile)
+    # A SPIR-V binary is named after its shader source file, with a `.spv` extension added.
+    list(APPEND shaderSourceFiles)
+    foreach(spirvBinaryFile IN LISTS inSpirvBinaryFiles)
+        get_filename_component(shaderSourceFileName "${spirvBinaryFile}" NAME_WLE)
+        list(APPEND shaderSourceFiles "${shaderSourceFileName}")
+    endforeach()
 
     list(APPEND spirvBinaries)
-    CompileGLSL_ReadSpirvBinaries("${spirvBinaryFiles}" spirvBinaries)
+    CompileGLSL_ReadSpirvBinaries("${inSpirvBinaryFiles}" spirvBinaries)
 
     string(APPEND spirvBinaryEmbedding "")
-    CompileGLSL_EmbedShaders("${inShaderSourceFiles}" "${spirvBinaryFiles}" "${spirvBinaries}" spirvBinaryEmbedding)
+    CompileGLSL_EmbedShaders("${shaderSourceFiles}" "${inSpirvBinaryFiles}" "${spirvBinaries}" spirvBinaryEmbedding)
 
     CompileGLSL_CreateEmbeddingFile(
         "${spirvBinaryEmbedding}"
@@ -297,7 +309,7 @@ function(CompileGLSL_FindCompilerCommands GLSL_COMPILER_COMMAND)
 endfunction()
 
 function(CompileGLSL_FindSourceFiles inShaderPath outFoundShaderFiles)
-    file(GLOB_RECURSE GLSL_SOURCE_FILES
+    file(GLOB_RECURSE GLSL_SOURCE_FILES CONFIGURE_DEPENDS
         "${inShaderPath}/*.frag.glsl"
         "${inShaderPath}/*.vert.glsl"
         "${inShaderPath}/*.comp.glsl"
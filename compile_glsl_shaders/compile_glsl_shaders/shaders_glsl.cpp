@@ -2,14 +2,54 @@
 
 #include "shaders_glsl.h.in"
 
+#include <array>
+#include <stdexcept>
 
-std::unordered_map<std::string, std::vector<uint8_t>> shaders_glsl::createGlslShaders() {
-    const auto shaders = std::unordered_map<std::string, std::vector<uint8_t>> {
-        { shader_compute_comp_glsl, std::vector<uint8_t> { shader_compute_comp_glsl_spv.begin(), shader_compute_comp_glsl_spv.end() } },
-        { shader_compute_frag_glsl, std::vector<uint8_t> { shader_compute_frag_glsl_spv.begin(), shader_compute_frag_glsl_spv.end() } },
-        { shader_compute_vert_glsl, std::vector<uint8_t> { shader_compute_vert_glsl_spv.begin(), shader_compute_vert_glsl_spv.end() } },
-    };
 
-    return shaders;
+namespace {
+
+using ShaderBinary = shaders_glsl::ShaderBinary;
+
+constexpr ShaderBinary makeShaderBinary(std::string_view fileName, std::span<const uint32_t> code) {
+    return ShaderBinary { shaders_glsl::hashShaderFileName(fileName), fileName, code };
+}
+
+constexpr auto SHADERS = std::array<ShaderBinary, 5> {
+    makeShaderBinary(shader_compute_comp_glsl, shader_compute_comp_glsl_spv),
+    makeShaderBinary(shader_compute_soa_comp_glsl, shader_compute_soa_comp_glsl_spv),
+    makeShaderBinary(shader_compute_frag_glsl, shader_compute_frag_glsl_spv),
+    makeShaderBinary(shader_compute_vert_glsl, shader_compute_vert_glsl_spv),
+    makeShaderBinary(shader_init_comp_glsl, shader_init_comp_glsl_spv),
+};
+
+// Two file names hashing to the same key would make one of the shaders unreachable.
+consteval bool hasUniqueKeys() {
+    for (size_t i = 0; i < SHADERS.size(); i++) {
+        for (size_t j = i + 1; j < SHADERS.size(); j++) {
+            if (SHADERS[i].key == SHADERS[j].key) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static_assert(hasUniqueKeys(), "two embedded shaders share a key");
+
 }
 
+
+std::span<const shaders_glsl::ShaderBinary> shaders_glsl::getShaders() {
+    return SHADERS;
+}
+
+std::span<const uint32_t> shaders_glsl::getShader(uint64_t key) {
+    for (const auto& shader : SHADERS) {
+        if (shader.key == key) {
+            return shader.code;
+        }
+    }
+
+    throw std::out_of_range("no embedded shader has the given key!");
+}
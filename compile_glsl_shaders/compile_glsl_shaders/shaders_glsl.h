@@ -1,13 +1,39 @@
 #ifndef _SHADERS_GLSL_H
 #define _SHADERS_GLSL_H
 
-#include <unordered_map>
-#include <string>
-#include <vector>
+#include <cstdint>
+#include <span>
+#include <string_view>
 
 namespace shaders_glsl {
 
-std::unordered_map<std::string, std::vector<uint8_t>> createGlslShaders();
+// An embedded SPIR-V binary. The code points straight into the read-only data of the library, so it is
+// never copied, and is aligned to whole SPIR-V words.
+struct ShaderBinary final {
+    uint64_t key;
+    std::string_view fileName;
+    std::span<const uint32_t> code;
+};
+
+// Hashes a shader file name with FNV-1a, which makes up the key a shader is looked up by.
+constexpr uint64_t hashShaderFileName(std::string_view fileName) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char character : fileName) {
+        hash = (hash ^ static_cast<uint8_t>(character)) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+// The key of the shader compiled from `fileName`, computed at compile time.
+consteval uint64_t shaderKey(std::string_view fileName) {
+    return hashShaderFileName(fileName);
+}
+
+std::span<const ShaderBinary> getShaders();
+
+// Returns the code of the shader with the given key, and throws `std::out_of_range` when there is none.
+std::span<const uint32_t> getShader(uint64_t key);
 
 }
 
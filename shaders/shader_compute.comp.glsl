@@ -8,6 +8,8 @@ struct Particle {
 
 layout (binding = 0) uniform ParameterUBO {
     float deltaTime;
+    uint particleCount;
+    uint groupCountX;
 } ubo;
 
 layout(std140, binding = 1) readonly buffer ParticleSSBOIn {
@@ -18,11 +20,18 @@ layout(std140, binding = 2) buffer ParticleSSBOOut {
     Particle particlesOut[ ];
 };
 
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+// The host specializes the workgroup size with the size tuned for the device.
+layout (local_size_x_id = 0, local_size_y = 1, local_size_z = 1) in;
 
 
 void main() {
-    uint index = gl_GlobalInvocationID.x;  
+    // Large particle counts are dispatched as a two-dimensional grid of workgroups.
+    uint index = gl_GlobalInvocationID.y * (ubo.groupCountX * gl_WorkGroupSize.x) + gl_GlobalInvocationID.x;
+    
+    // The last workgroup is only partially filled when the particle count is not a multiple of the workgroup size.
+    if (index >= ubo.particleCount) {
+        return;
+    }
 
     Particle particleIn = particlesIn[index];
 
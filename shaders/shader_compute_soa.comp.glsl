@@ -0,0 +1,52 @@
+#version 450
+
+layout (binding = 0) uniform ParameterUBO {
+    float deltaTime;
+    uint particleCount;
+    uint groupCountX;
+} ubo;
+
+// The particle color never changes, so it is kept out of the integration kernel entirely.
+layout(std430, binding = 1) readonly buffer PositionSSBOIn {
+    vec2 positionsIn[ ];
+};
+
+layout(std430, binding = 2) readonly buffer VelocitySSBOIn {
+    vec2 velocitiesIn[ ];
+};
+
+layout(std430, binding = 3) writeonly buffer PositionSSBOOut {
+    vec2 positionsOut[ ];
+};
+
+layout(std430, binding = 4) writeonly buffer VelocitySSBOOut {
+    vec2 velocitiesOut[ ];
+};
+
+// The host specializes the workgroup size with the size tuned for the device.
+layout (local_size_x_id = 0, local_size_y = 1, local_size_z = 1) in;
+
+
+void main() {
+    // Large particle counts are dispatched as a two-dimensional grid of workgroups.
+    uint index = gl_GlobalInvocationID.y * (ubo.groupCountX * gl_WorkGroupSize.x) + gl_GlobalInvocationID.x;
+
+    // The last workgroup is only partially filled when the particle count is not a multiple of the workgroup size.
+    if (index >= ubo.particleCount) {
+        return;
+    }
+
+    vec2 position = positionsIn[index] + velocitiesIn[index] * ubo.deltaTime;
+    vec2 velocity = velocitiesIn[index];
+
+    // Flip movement at window border
+    if ((position.x <= -1.0) || (position.x >= 1.0)) {
+        velocity.x = -velocity.x;
+    }
+    if ((position.y <= -1.0) || (position.y >= 1.0)) {
+        velocity.y = -velocity.y;
+    }
+
+    positionsOut[index] = position;
+    velocitiesOut[index] = velocity;
+}
@@ -0,0 +1,74 @@
+#version 450
+
+struct Particle {
+	vec2 position;
+	vec2 velocity;
+    vec4 color;
+};
+
+layout (push_constant) uniform InitParameters {
+    uint seedLow;
+    uint seedHigh;
+    uint particleCount;
+    uint groupCountX;
+    float aspectRatio;
+} params;
+
+layout(std140, binding = 0) writeonly buffer ParticleSSBOOut {
+    Particle particlesOut[ ];
+};
+
+// The host specializes the workgroup size with the size tuned for the device.
+layout (local_size_x_id = 0, local_size_y = 1, local_size_z = 1) in;
+
+
+const uint PHILOX_MULTIPLIER_0 = 0xD2511F53u;
+const uint PHILOX_MULTIPLIER_1 = 0xCD9E8D57u;
+const uint PHILOX_WEYL_0 = 0x9E3779B9u;
+const uint PHILOX_WEYL_1 = 0xBB67AE85u;
+const float PI = 3.14159265358979323846;
+
+// Philox4x32-10, matching `Philox4x32::generate` on the CPU.
+uvec4 philox4x32(uvec4 counter, uvec2 key) {
+    for (int i = 0; i < 10; i++) {
+        if (i > 0) {
+            key += uvec2(PHILOX_WEYL_0, PHILOX_WEYL_1);
+        }
+
+        uint hi0, lo0, hi1, lo1;
+        umulExtended(PHILOX_MULTIPLIER_0, counter.x, hi0, lo0);
+        umulExtended(PHILOX_MULTIPLIER_1, counter.z, hi1, lo1);
+
+        counter = uvec4(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+    }
+
+    return counter;
+}
+
+float toUniformFloat(uint value) {
+    return float(value >> 8) * (1.0 / 16777216.0);
+}
+
+void main() {
+    // Large particle counts are dispatched as a two-dimensional grid of workgroups.
+    uint index = gl_GlobalInvocationID.y * (params.groupCountX * gl_WorkGroupSize.x) + gl_GlobalInvocationID.x;
+
+    // The last workgroup is only partially filled when the particle count is not a multiple of the workgroup size.
+    if (index >= params.particleCount) {
+        return;
+    }
+
+    // The same counter layout as `ParticleGenerator::generateParticle`, so both draw the same random words.
+    uvec2 key = uvec2(params.seedLow, params.seedHigh);
+    uvec4 block0 = philox4x32(uvec4(index, 0u, 0u, 0u), key);
+    uvec4 block1 = philox4x32(uvec4(index, 0u, 1u, 0u), key);
+
+    float r = 0.25 * sqrt(toUniformFloat(block0.x));
+    float theta = toUniformFloat(block0.y) * 2.0 * PI;
+    float x = r * cos(theta) * params.aspectRatio;
+    float y = r * sin(theta);
+
+    particlesOut[index].position = vec2(x, y);
+    particlesOut[index].velocity = normalize(vec2(x, y)) * 0.00025;
+    particlesOut[index].color = vec4(toUniformFloat(block0.z), toUniformFloat(block0.w), toUniformFloat(block1.x), 1.0);
+}
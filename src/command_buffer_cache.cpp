@@ -0,0 +1,88 @@
+#include "command_buffer_cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+using CommandBufferCache = VulkanEngine::CommandBufferCache;
+
+CommandBufferCache::CommandBufferCache(Engine& engine, VkCommandPool commandPool, uint32_t frameCount, uint32_t variantCount)
+    : m_engine { engine }
+    , m_commandPool { commandPool }
+    , m_frameCount { frameCount }
+    , m_variantCount { variantCount }
+    , m_commandBuffers(static_cast<size_t>(frameCount) * variantCount, VK_NULL_HANDLE)
+    , m_isRecorded(static_cast<size_t>(frameCount) * variantCount, false)
+    , m_recordingCount { 0 }
+{
+}
+
+CommandBufferCache::~CommandBufferCache() {
+    this->freeCommandBuffers();
+}
+
+VkCommandBuffer CommandBufferCache::get(uint32_t frameIndex, uint32_t variantIndex, const Recorder& recorder) {
+    if (frameIndex >= m_frameCount || variantIndex >= m_variantCount) {
+        throw std::out_of_range("command buffer cache index is out of range!");
+    }
+
+    const size_t index = static_cast<size_t>(frameIndex) * m_variantCount + variantIndex;
+    if (m_isRecorded[index]) {
+        return m_commandBuffers[index];
+    }
+
+    if (m_commandBuffers[index] == VK_NULL_HANDLE) {
+        const auto allocInfo = VkCommandBufferAllocateInfo {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = m_commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+        const auto result = vkAllocateCommandBuffers(m_engine.getLogicalDevice(), &allocInfo, &m_commandBuffers[index]);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate cached command buffer!");
+        }
+    } else {
+        vkResetCommandBuffer(m_commandBuffers[index], /*VkCommandBufferResetFlagBits*/ 0);
+    }
+
+    recorder(m_commandBuffers[index], frameIndex, variantIndex);
+
+    m_isRecorded[index] = true;
+    m_recordingCount++;
+
+    return m_commandBuffers[index];
+}
+
+void CommandBufferCache::invalidate() {
+    // The command buffers themselves are kept, and reset right before they are recorded again.
+    std::fill(m_isRecorded.begin(), m_isRecorded.end(), false);
+}
+
+void CommandBufferCache::invalidate(uint32_t variantCount) {
+    if (variantCount == m_variantCount) {
+        this->invalidate();
+
+        return;
+    }
+
+    this->freeCommandBuffers();
+
+    m_variantCount = variantCount;
+    m_commandBuffers.assign(static_cast<size_t>(m_frameCount) * variantCount, VK_NULL_HANDLE);
+    m_isRecorded.assign(static_cast<size_t>(m_frameCount) * variantCount, false);
+}
+
+uint64_t CommandBufferCache::getRecordingCount() const {
+    return m_recordingCount;
+}
+
+void CommandBufferCache::freeCommandBuffers() {
+    for (auto& commandBuffer : m_commandBuffers) {
+        if (commandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(m_engine.getLogicalDevice(), m_commandPool, 1, &commandBuffer);
+            commandBuffer = VK_NULL_HANDLE;
+        }
+    }
+}
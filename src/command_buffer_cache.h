@@ -0,0 +1,60 @@
+#ifndef _COMMAND_BUFFER_CACHE_H
+#define _COMMAND_BUFFER_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include "engine.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Keeps one pre-recorded command buffer per frame slot and variant, such as the swap chain image a
+// draw renders into, and records each of them only the first time it is needed. Work whose commands
+// stay the same from frame to frame is then submitted again as is, and everything that changes per
+// frame has to come from buffer contents instead.
+//
+// A command buffer is only ever submitted by frames of its own slot, so it is never pending twice, and
+// the frame scheduler's wait for the slot also makes it safe to record again. `invalidate` drops every
+// recording, for instance when the swap chain or a pipeline is recreated. It may be called between two
+// frames without waiting for the device, since a recording is only replaced after the wait for its slot,
+// but anything the old recordings use has to outlive the frames already submitted.
+class CommandBufferCache final {
+    public:
+        using Recorder = std::function<void(VkCommandBuffer, uint32_t, uint32_t)>;
+
+        explicit CommandBufferCache(Engine& engine, VkCommandPool commandPool, uint32_t frameCount, uint32_t variantCount);
+
+        ~CommandBufferCache();
+
+        CommandBufferCache(const CommandBufferCache&) = delete;
+        CommandBufferCache& operator=(const CommandBufferCache&) = delete;
+
+        // Returns the command buffer of the frame slot and variant, which `recorder` records first when the
+        // cache has no valid recording of it.
+        VkCommandBuffer get(uint32_t frameIndex, uint32_t variantIndex, const Recorder& recorder);
+
+        void invalidate();
+
+        // Drops every recording and changes the number of variants per frame slot.
+        void invalidate(uint32_t variantCount);
+
+        uint64_t getRecordingCount() const;
+    private:
+        Engine& m_engine;
+        VkCommandPool m_commandPool;
+        uint32_t m_frameCount;
+        uint32_t m_variantCount;
+        std::vector<VkCommandBuffer> m_commandBuffers;
+        std::vector<bool> m_isRecorded;
+        uint64_t m_recordingCount;
+
+        void freeCommandBuffers();
+};
+
+}
+
+#endif // _COMMAND_BUFFER_CACHE_H
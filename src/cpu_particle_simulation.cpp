@@ -0,0 +1,73 @@
+#include "cpu_particle_simulation.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+// Splitting every step into several chunks per thread gives idle threads something to steal.
+const size_t CHUNKS_PER_THREAD = 8;
+
+// Below this size a chunk costs more to schedule than to integrate.
+const size_t MIN_CHUNK_PARTICLE_COUNT = 4096;
+
+static_assert(CACHE_LINE_SIZE % sizeof(Particle) == 0);
+
+
+CpuParticleSimulation::CpuParticleSimulation(std::span<const Particle> initialParticles, size_t frameCount, size_t threadCount)
+    : m_threadPool { threadCount }
+    , m_integrator {}
+    , m_particleBuffers {}
+    , m_chunkSize { 0 }
+{
+    if (frameCount == 0) {
+        throw std::runtime_error("the CPU particle simulation needs at least one frame!");
+    }
+
+    // Every buffer starts out with the initial state, just like the shader storage buffers.
+    for (size_t i = 0; i < frameCount; i++) {
+        m_particleBuffers.emplace_back(initialParticles.begin(), initialParticles.end());
+    }
+
+    const size_t particlesPerCacheLine = CACHE_LINE_SIZE / sizeof(Particle);
+    const size_t chunkCount = m_threadPool.getThreadCount() * CHUNKS_PER_THREAD;
+    const size_t chunkSize = std::max((initialParticles.size() + chunkCount - 1) / chunkCount, MIN_CHUNK_PARTICLE_COUNT);
+
+    m_chunkSize = ((chunkSize + particlesPerCacheLine - 1) / particlesPerCacheLine) * particlesPerCacheLine;
+}
+
+void CpuParticleSimulation::step(size_t currentFrame, float deltaTime, uint32_t substepCount) {
+    const size_t frameCount = m_particleBuffers.size();
+    const auto& particlesIn = m_particleBuffers[(currentFrame + frameCount - 1) % frameCount];
+    auto& particlesOut = m_particleBuffers[currentFrame % frameCount];
+
+    m_threadPool.parallelFor(particlesIn.size(), m_chunkSize, [&](size_t begin, size_t end) {
+        const auto chunkIn = std::span<const Particle> { particlesIn.data() + begin, end - begin };
+        const auto chunkOut = std::span<Particle> { particlesOut.data() + begin, end - begin };
+        if (substepCount == 0) {
+            std::copy(chunkIn.begin(), chunkIn.end(), chunkOut.begin());
+
+            return;
+        }
+
+        m_integrator.integrate(chunkIn, chunkOut, deltaTime);
+        for (uint32_t substep = 1; substep < substepCount; substep++) {
+            m_integrator.integrate(chunkOut, chunkOut, deltaTime);
+        }
+    });
+}
+
+std::span<const Particle> CpuParticleSimulation::getParticles(size_t frame) const {
+    return std::span<const Particle> { m_particleBuffers[frame % m_particleBuffers.size()] };
+}
+
+size_t CpuParticleSimulation::getParticleCount() const {
+    return m_particleBuffers[0].size();
+}
+
+size_t CpuParticleSimulation::getThreadCount() const {
+    return m_threadPool.getThreadCount();
+}
+
+SimdLevel CpuParticleSimulation::getSimdLevel() const {
+    return m_integrator.getSimdLevel();
+}
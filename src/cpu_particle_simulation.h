@@ -0,0 +1,66 @@
+#ifndef _CPU_PARTICLE_SIMULATION_H
+#define _CPU_PARTICLE_SIMULATION_H
+
+#include "particle.h"
+#include "particle_integrator.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <vector>
+
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// Allocates storage aligned to a cache line, so that chunks which are a whole number of cache lines
+// long never share a line with the neighboring chunk on another thread.
+template <typename T>
+struct CacheLineAllocator {
+    using value_type = T;
+
+    CacheLineAllocator() = default;
+
+    template <typename U>
+    CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t { CACHE_LINE_SIZE }));
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        ::operator delete(pointer, count * sizeof(T), std::align_val_t { CACHE_LINE_SIZE });
+    }
+
+    template <typename U>
+    bool operator==(const CacheLineAllocator<U>&) const {
+        return true;
+    }
+};
+
+using ParticleBuffer = std::vector<Particle, CacheLineAllocator<Particle>>;
+
+// Runs the particle simulation on the CPU across a thread pool. The simulation keeps one particle
+// buffer per frame in flight, and follows the same ping-pong scheme as the shader storage buffers:
+// the step for a frame reads the particles of the previous frame and writes its own buffer. A step
+// made of several substeps runs them all on one chunk before moving on to the next, integrating in
+// place after the first substep, since every particle only depends on itself.
+class CpuParticleSimulation final {
+    public:
+        explicit CpuParticleSimulation(std::span<const Particle> initialParticles, size_t frameCount, size_t threadCount);
+
+        void step(size_t currentFrame, float deltaTime, uint32_t substepCount);
+
+        std::span<const Particle> getParticles(size_t frame) const;
+        size_t getParticleCount() const;
+        size_t getThreadCount() const;
+        SimdLevel getSimdLevel() const;
+    private:
+        ThreadPool m_threadPool;
+        ParticleIntegrator m_integrator;
+        std::vector<ParticleBuffer> m_particleBuffers;
+        size_t m_chunkSize;
+};
+
+#endif // _CPU_PARTICLE_SIMULATION_H
@@ -279,12 +279,21 @@ using InstanceSpecProvider = VulkanEngine::InstanceSpecProvider;
 InstanceSpecProvider::InstanceSpecProvider(bool enableValidationLayers, bool enableDebuggingExtensions)
     : m_enableValidationLayers { enableValidationLayers }
     , m_enableDebuggingExtensions { enableDebuggingExtensions }
+    , m_enableWindowSystem { true }
+{
+}
+
+InstanceSpecProvider::InstanceSpecProvider(bool enableValidationLayers, bool enableDebuggingExtensions, bool enableWindowSystem)
+    : m_enableValidationLayers { enableValidationLayers }
+    , m_enableDebuggingExtensions { enableDebuggingExtensions }
+    , m_enableWindowSystem { enableWindowSystem }
 {
 }
 
 InstanceSpecProvider::~InstanceSpecProvider() {
     m_enableValidationLayers = false;
     m_enableDebuggingExtensions = false;
+    m_enableWindowSystem = false;
 }
 
 VulkanInstanceSpec InstanceSpecProvider::createInstanceSpec() const {
@@ -324,7 +333,11 @@ std::vector<std::string> InstanceSpecProvider::getWindowSystemInstanceRequiremen
 }
 
 std::vector<std::string> InstanceSpecProvider::getInstanceExtensions() const {
-    auto instanceExtensions = this->getWindowSystemInstanceRequirements();
+    auto instanceExtensions = std::vector<std::string> {};
+    if (m_enableWindowSystem) {
+        instanceExtensions = this->getWindowSystemInstanceRequirements();
+    }
+
     instanceExtensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
     instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
     if (m_enableDebuggingExtensions) {
@@ -469,10 +482,15 @@ bool PhysicalDeviceSpec::hasPresentFamily() const {
 
 using PhysicalDeviceSpecProvider = VulkanEngine::PhysicalDeviceSpecProvider;
 
+PhysicalDeviceSpecProvider::PhysicalDeviceSpecProvider(bool requirePresentFamily)
+    : m_requirePresentFamily { requirePresentFamily }
+{
+}
+
 PhysicalDeviceSpec PhysicalDeviceSpecProvider::createPhysicalDeviceSpec() const {
     const auto requiredExtensions = this->getPhysicalDeviceRequirements();
 
-    return PhysicalDeviceSpec { requiredExtensions, true, true };
+    return PhysicalDeviceSpec { requiredExtensions, true, m_requirePresentFamily };
 }
 
 std::vector<std::string> PhysicalDeviceSpecProvider::getPhysicalDeviceRequirements() const {
@@ -481,7 +499,9 @@ std::vector<std::string> PhysicalDeviceSpecProvider::getPhysicalDeviceRequiremen
         physicalDeviceExtensions.push_back(VulkanEngine::Constants::VK_KHR_portability_subset);
     }
 
-    physicalDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (m_requirePresentFamily) {
+        physicalDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     return physicalDeviceExtensions;
 }
@@ -514,6 +534,16 @@ QueueFamilyIndices PhysicalDeviceSelector::findQueueFamilies(VkPhysicalDevice ph
             indices.graphicsAndComputeFamily = i;
         }
 
+        // A headless device has no surface to present to, so only the compute side needs to be found.
+        if (surface == VK_NULL_HANDLE) {
+            if (indices.isCompleteHeadless()) {
+                break;
+            }
+
+            i++;
+            continue;
+        }
+
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
 
@@ -528,6 +558,9 @@ QueueFamilyIndices PhysicalDeviceSelector::findQueueFamilies(VkPhysicalDevice ph
         i++;
     }
 
+    indices.dedicatedComputeFamily = QueueFamilyIndices::findDedicatedComputeFamily(queueFamilies);
+    indices.dedicatedTransferFamily = QueueFamilyIndices::findDedicatedTransferFamily(queueFamilies);
+
     return indices;
 }
 
@@ -578,6 +611,18 @@ bool PhysicalDeviceSelector::isPhysicalDeviceCompatible(VkPhysicalDevice physica
         physicalDeviceSpec.requiredExtensions()
     );
 
+    const bool areVulkan12FeaturesSupported = this->checkVulkan12FeatureSupport(physicalDevice);
+
+    if (!physicalDeviceSpec.hasPresentFamily()) {
+        auto supportedFeatures = VkPhysicalDeviceFeatures {};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+        return indices.isCompleteHeadless()
+            && areRequiredExtensionsSupported
+            && areVulkan12FeaturesSupported
+            && supportedFeatures.samplerAnisotropy;
+    }
+
     bool swapChainCompatible = false;
     if (areRequiredExtensionsSupported) {
         SwapChainSupportDetails swapChainSupport = this->querySwapChainSupport(physicalDevice, surface);
@@ -587,7 +632,30 @@ bool PhysicalDeviceSelector::isPhysicalDeviceCompatible(VkPhysicalDevice physica
     auto supportedFeatures = VkPhysicalDeviceFeatures {};
     vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
 
-    return indices.isComplete() && areRequiredExtensionsSupported && swapChainCompatible && supportedFeatures.samplerAnisotropy;
+    return indices.isComplete()
+        && areRequiredExtensionsSupported
+        && areVulkan12FeaturesSupported
+        && swapChainCompatible
+        && supportedFeatures.samplerAnisotropy;
+}
+
+bool PhysicalDeviceSelector::checkVulkan12FeatureSupport(VkPhysicalDevice physicalDevice) const {
+    auto properties = VkPhysicalDeviceProperties {};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        return false;
+    }
+
+    auto vulkan12Features = VkPhysicalDeviceVulkan12Features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    };
+    auto supportedFeatures = VkPhysicalDeviceFeatures2 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &vulkan12Features,
+    };
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    return vulkan12Features.timelineSemaphore == VK_TRUE && vulkan12Features.hostQueryReset == VK_TRUE;
 }
 
 std::vector<VkPhysicalDevice> PhysicalDeviceSelector::findAllPhysicalDevices() const {
@@ -671,7 +739,9 @@ std::vector<std::string> LogicalDeviceSpecProvider::getLogicalDeviceRequirements
         logicalDeviceExtensions.push_back(VulkanEngine::Constants::VK_KHR_portability_subset);
     }
 
-    logicalDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (m_surface != VK_NULL_HANDLE) {
+        logicalDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     return logicalDeviceExtensions;
 }
@@ -707,6 +777,16 @@ QueueFamilyIndices LogicalDeviceFactory::findQueueFamilies(VkPhysicalDevice phys
             indices.graphicsAndComputeFamily = i;
         }
 
+        // A headless device has no surface to present to, so only the compute side needs to be found.
+        if (surface == VK_NULL_HANDLE) {
+            if (indices.isCompleteHeadless()) {
+                break;
+            }
+
+            i++;
+            continue;
+        }
+
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
 
@@ -721,6 +801,9 @@ QueueFamilyIndices LogicalDeviceFactory::findQueueFamilies(VkPhysicalDevice phys
         i++;
     }
 
+    indices.dedicatedComputeFamily = QueueFamilyIndices::findDedicatedComputeFamily(queueFamilies);
+    indices.dedicatedTransferFamily = QueueFamilyIndices::findDedicatedTransferFamily(queueFamilies);
+
     return indices;
 }
 
@@ -747,12 +830,17 @@ SwapChainSupportDetails LogicalDeviceFactory::querySwapChainSupport(VkPhysicalDe
     return details;
 }
 
-std::tuple<VkDevice, VkQueue, VkQueue, VkQueue> LogicalDeviceFactory::createLogicalDevice(const LogicalDeviceSpec& logicalDeviceSpec) {
+std::tuple<VkDevice, VkQueue, VkQueue, VkQueue, VkQueue> LogicalDeviceFactory::createLogicalDevice(const LogicalDeviceSpec& logicalDeviceSpec) {
     const auto indices = this->findQueueFamilies(m_physicalDevice, m_surface);
-    const auto uniqueQueueFamilies = std::set<uint32_t> {
-        indices.graphicsAndComputeFamily.value(), 
-        indices.presentFamily.value()
+    auto uniqueQueueFamilies = std::set<uint32_t> {
+        indices.graphicsAndComputeFamily.value(),
+        indices.getComputeFamily(),
+        indices.getTransferFamily()
     };
+    if (indices.presentFamily.has_value()) {
+        uniqueQueueFamilies.insert(indices.presentFamily.value());
+    }
+
     const float queuePriority = 1.0f;
     auto queueCreateInfos = std::vector<VkDeviceQueueCreateInfo> {};
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -801,9 +889,17 @@ std::tuple<VkDevice, VkQueue, VkQueue, VkQueue> LogicalDeviceFactory::createLogi
     const auto deviceFeatures = VkPhysicalDeviceFeatures {
         .samplerAnisotropy = requireSamplerAnisotropy,
     };
+    // Frames are paced with timeline semaphores, and the GPU profiler resets its queries from the host.
+    // Both are core in Vulkan 1.2 but have to be enabled.
+    const auto vulkan12Features = VkPhysicalDeviceVulkan12Features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .hostQueryReset = VK_TRUE,
+        .timelineSemaphore = VK_TRUE,
+    };
 
     const auto createInfo = VkDeviceCreateInfo {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &vulkan12Features,
         .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
         .pQueueCreateInfos = queueCreateInfos.data(),
         .pEnabledFeatures = &deviceFeatures,
@@ -822,13 +918,20 @@ std::tuple<VkDevice, VkQueue, VkQueue, VkQueue> LogicalDeviceFactory::createLogi
     auto graphicsQueue = VkQueue {};
     vkGetDeviceQueue(device, indices.graphicsAndComputeFamily.value(), 0, &graphicsQueue);
 
+    // Without a dedicated compute family this is the graphics queue itself.
     auto computeQueue = VkQueue {};
-    vkGetDeviceQueue(device, indices.graphicsAndComputeFamily.value(), 0, &computeQueue);
+    vkGetDeviceQueue(device, indices.getComputeFamily(), 0, &computeQueue);
+
+    // Without a dedicated transfer family this is the graphics queue itself.
+    auto transferQueue = VkQueue {};
+    vkGetDeviceQueue(device, indices.getTransferFamily(), 0, &transferQueue);
         
-    auto presentQueue = VkQueue {};
-    vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    auto presentQueue = VkQueue { VK_NULL_HANDLE };
+    if (indices.presentFamily.has_value()) {
+        vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    }
 
-    return std::make_tuple(device, graphicsQueue, computeQueue, presentQueue);
+    return std::make_tuple(device, graphicsQueue, computeQueue, transferQueue, presentQueue);
 }
 
 std::vector<const char*> LogicalDeviceFactory::convertToCStrings(const std::vector<std::string>& strings) {
@@ -1051,6 +1154,16 @@ void WindowSystem::framebufferResizeCallback(GLFWwindow* window, int width, int
 
 
 using GpuDevice = VulkanEngine::GpuDevice;
+using MemoryAllocator = VulkanEngine::MemoryAllocator;
+using MemoryAllocation = VulkanEngine::MemoryAllocation;
+using MemoryStats = VulkanEngine::MemoryStats;
+using PipelineCache = VulkanEngine::PipelineCache;
+using ShaderCodeLifetime = VulkanEngine::ShaderCodeLifetime;
+using ShaderModuleCache = VulkanEngine::ShaderModuleCache;
+using ShaderModuleCacheStats = VulkanEngine::ShaderModuleCacheStats;
+using ShaderReflection = VulkanEngine::ShaderReflection;
+using ShaderReflectionCache = VulkanEngine::ShaderReflectionCache;
+using MappedFile = VulkanEngine::MappedFile;
 
 GpuDevice::GpuDevice(
     VkInstance instance,
@@ -1058,30 +1171,57 @@ GpuDevice::GpuDevice(
     VkDevice device, 
     VkQueue graphicsQueue,
     VkQueue computeQueue,
+    VkQueue transferQueue,
     VkQueue presentQueue,
-    VkCommandPool commandPool
+    VkCommandPool commandPool,
+    VkCommandPool computeCommandPool,
+    VkCommandPool transferCommandPool,
+    QueueFamilyIndices queueFamilyIndices
 )   : m_instance { instance }
     , m_physicalDevice { physicalDevice }
     , m_device { device }
     , m_graphicsQueue { graphicsQueue }
     , m_computeQueue { computeQueue }
+    , m_transferQueue { transferQueue }
     , m_presentQueue { presentQueue }
     , m_commandPool { commandPool }
-    , m_shaderModules { std::unordered_set<VkShaderModule> {} }
+    , m_computeCommandPool { computeCommandPool }
+    , m_transferCommandPool { transferCommandPool }
+    , m_queueFamilyIndices { queueFamilyIndices }
+    , m_shaderModuleCache { std::make_unique<ShaderModuleCache>(device) }
+    , m_shaderReflectionCache { std::make_unique<ShaderReflectionCache>() }
+    , m_memoryAllocator { std::make_unique<MemoryAllocator>(physicalDevice, device) }
+    , m_pipelineCache { std::make_unique<PipelineCache>(physicalDevice, device) }
 {
     m_msaaSamples = GpuDevice::getMaxUsableSampleCount(physicalDevice);
 }
 
 GpuDevice::~GpuDevice() {
-    for (const auto& shaderModule : m_shaderModules) {
-        vkDestroyShaderModule(m_device, shaderModule, nullptr);
+    m_shaderModuleCache.reset();
+
+    m_memoryAllocator.reset();
+
+    try {
+        // Picks up pipelines created since the cache was last saved.
+        m_pipelineCache->save();
+    } catch (const std::runtime_error& exception) {
+        fmt::println(std::cerr, "{}", exception.what());
     }
+    m_pipelineCache.reset();
 
     vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    if (m_transferCommandPool != m_commandPool) {
+        vkDestroyCommandPool(m_device, m_transferCommandPool, nullptr);
+    }
+    if (m_computeCommandPool != m_commandPool) {
+        vkDestroyCommandPool(m_device, m_computeCommandPool, nullptr);
+    }
     vkDestroyCommandPool(m_device, m_commandPool, nullptr);
     vkDestroyDevice(m_device, nullptr);
 
     m_surface = VK_NULL_HANDLE;
+    m_transferCommandPool = VK_NULL_HANDLE;
+    m_computeCommandPool = VK_NULL_HANDLE;
     m_commandPool = VK_NULL_HANDLE;
     m_presentQueue = VK_NULL_HANDLE;
     m_graphicsQueue = VK_NULL_HANDLE;
@@ -1106,6 +1246,10 @@ VkQueue GpuDevice::getComputeQueue() const {
     return m_computeQueue;
 }
 
+VkQueue GpuDevice::getTransferQueue() const {
+    return m_transferQueue;
+}
+
 VkQueue GpuDevice::getPresentQueue() const {
     return m_presentQueue;
 }
@@ -1114,6 +1258,18 @@ VkCommandPool GpuDevice::getCommandPool() const {
     return m_commandPool;
 }
 
+VkCommandPool GpuDevice::getComputeCommandPool() const {
+    return m_computeCommandPool;
+}
+
+VkCommandPool GpuDevice::getTransferCommandPool() const {
+    return m_transferCommandPool;
+}
+
+const QueueFamilyIndices& GpuDevice::getQueueFamilyIndices() const {
+    return m_queueFamilyIndices;
+}
+
 VkSampleCountFlagBits GpuDevice::getMsaaSamples() const {
     return m_msaaSamples;
 }
@@ -1145,9 +1301,10 @@ VkSurfaceKHR GpuDevice::createRenderSurface(SurfaceProvider& surfaceProvider) {
 }
 
 VkShaderModule GpuDevice::createShaderModuleFromFile(const std::string& fileName) {
-    const auto shaderCode = this->loadShaderFromFile(fileName);
+    const auto shaderFile = this->loadShaderFromFile(fileName);
+    const auto shaderCode = shaderFile.getBytes();
 
-    return this->createShaderModule(shaderCode);
+    return this->createShaderModule(GpuDevice::getShaderCodeWords(shaderCode.data(), shaderCode.size()), ShaderCodeLifetime::Transient);
 }
 
 VkShaderModule GpuDevice::createShaderModule(std::istream& stream) {
@@ -1157,43 +1314,43 @@ VkShaderModule GpuDevice::createShaderModule(std::istream& stream) {
 }
 
 VkShaderModule GpuDevice::createShaderModule(const std::vector<char>& code) {
-    const auto createInfo = VkShaderModuleCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .codeSize = code.size(),
-        .pCode = reinterpret_cast<const uint32_t*>(code.data()),
-        .pNext = nullptr,
-        .flags = 0,
-    };
+    return this->createShaderModule(GpuDevice::getShaderCodeWords(code.data(), code.size()), ShaderCodeLifetime::Transient);
+}
 
-    auto shaderModule = VkShaderModule {};
-    const auto result = vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module!");
-    }
+VkShaderModule GpuDevice::createShaderModule(const std::vector<unsigned char>& code) {
+    return this->createShaderModule(GpuDevice::getShaderCodeWords(code.data(), code.size()), ShaderCodeLifetime::Transient);
+}
 
-    m_shaderModules.insert(shaderModule);
+VkShaderModule GpuDevice::createShaderModule(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    return m_shaderModuleCache->acquire(code, codeLifetime);
+}
 
-    return shaderModule;
+void GpuDevice::releaseShaderModule(VkShaderModule shaderModule) {
+    m_shaderModuleCache->release(shaderModule);
 }
 
-VkShaderModule GpuDevice::createShaderModule(const std::vector<unsigned char>& code) {
-    const auto createInfo = VkShaderModuleCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .codeSize = code.size(),
-        .pCode = reinterpret_cast<const uint32_t*>(code.data()),
-        .pNext = nullptr,
-        .flags = 0,
-    };
+void GpuDevice::evictUnusedShaderModules() {
+    m_shaderModuleCache->evictUnused();
+}
 
-    auto shaderModule = VkShaderModule {};
-    const auto result = vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module!");
+ShaderModuleCacheStats GpuDevice::getShaderModuleCacheStats() const {
+    return m_shaderModuleCache->getStats();
+}
+
+const ShaderReflection& GpuDevice::reflectShader(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    return m_shaderReflectionCache->reflect(code, codeLifetime);
+}
+
+std::span<const uint32_t> GpuDevice::getShaderCodeWords(const void* code, size_t codeSize) {
+    if (codeSize == 0 || codeSize % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("shader code is not a whole number of SPIR-V words!");
     }
 
-    m_shaderModules.insert(shaderModule);
+    if (reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0) {
+        throw std::runtime_error("shader code is not aligned to SPIR-V words!");
+    }
 
-    return shaderModule;
+    return std::span<const uint32_t> { static_cast<const uint32_t*>(code), codeSize / sizeof(uint32_t) };
 }
 
 std::vector<char> GpuDevice::loadShader(std::istream& stream) {
@@ -1206,35 +1363,32 @@ std::vector<char> GpuDevice::loadShader(std::istream& stream) {
     return buffer;
 }
 
-std::ifstream GpuDevice::openShaderFile(const std::string& fileName) {
-    auto file = std::ifstream { fileName, std::ios::ate | std::ios::binary };
-
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
-    }
+MappedFile GpuDevice::loadShaderFromFile(const std::string& fileName) {
+    return MappedFile { fileName };
+}
 
-    return file;
+uint32_t GpuDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+    return m_memoryAllocator->findMemoryType(typeFilter, properties);
 }
 
-std::vector<char> GpuDevice::loadShaderFromFile(const std::string& fileName) {
-    auto stream = this->openShaderFile(fileName);
-    auto shader = this->loadShader(stream);
-    stream.close();
+MemoryAllocation GpuDevice::allocateMemory(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties) {
+    return m_memoryAllocator->allocate(memoryRequirements, properties);
+}
 
-    return shader;
+void GpuDevice::freeMemory(const MemoryAllocation& allocation) {
+    m_memoryAllocator->free(allocation);
 }
 
-uint32_t GpuDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    auto memProperties = VkPhysicalDeviceMemoryProperties {};
-    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
+MemoryStats GpuDevice::getMemoryStats() const {
+    return m_memoryAllocator->getStats();
+}
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
+PipelineCache& GpuDevice::getPipelineCache() {
+    return *m_pipelineCache;
+}
 
-    throw std::runtime_error("failed to find suitable memory type!");
+void GpuDevice::loadPipelineCache(const std::filesystem::path& filePath) {
+    m_pipelineCache = std::make_unique<PipelineCache>(m_physicalDevice, m_device, filePath);
 }
 
 
@@ -1242,6 +1396,15 @@ using GpuDeviceInitializer = VulkanEngine::GpuDeviceInitializer;
 
 GpuDeviceInitializer::GpuDeviceInitializer(VkInstance instance)
     : m_instance { instance }
+    , m_enableHeadless { false }
+    , m_dummySurface { VK_NULL_HANDLE }
+{
+}
+
+GpuDeviceInitializer::GpuDeviceInitializer(VkInstance instance, bool enableHeadless)
+    : m_instance { instance }
+    , m_enableHeadless { enableHeadless }
+    , m_dummySurface { VK_NULL_HANDLE }
 {
 }
 
@@ -1252,7 +1415,10 @@ GpuDeviceInitializer::~GpuDeviceInitializer() {
 }
 
 std::unique_ptr<GpuDevice> GpuDeviceInitializer::createGpuDevice() {
-    this->createDummySurface();
+    if (!m_enableHeadless) {
+        this->createDummySurface();
+    }
+
     this->selectPhysicalDevice();
     this->createLogicalDevice();
     this->createCommandPool();
@@ -1263,8 +1429,12 @@ std::unique_ptr<GpuDevice> GpuDeviceInitializer::createGpuDevice() {
         m_device,
         m_graphicsQueue,
         m_computeQueue,
+        m_transferQueue,
         m_presentQueue,
-        m_commandPool
+        m_commandPool,
+        m_computeCommandPool,
+        m_transferCommandPool,
+        m_queueFamilyIndices
     );
 
     return gpuDevice;
@@ -1285,6 +1455,16 @@ QueueFamilyIndices GpuDeviceInitializer::findQueueFamilies(VkPhysicalDevice phys
             indices.graphicsAndComputeFamily = i;
         }
 
+        // A headless device has no surface to present to, so only the compute side needs to be found.
+        if (surface == VK_NULL_HANDLE) {
+            if (indices.isCompleteHeadless()) {
+                break;
+            }
+
+            i++;
+            continue;
+        }
+
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
 
@@ -1299,6 +1479,9 @@ QueueFamilyIndices GpuDeviceInitializer::findQueueFamilies(VkPhysicalDevice phys
         i++;
     }
 
+    indices.dedicatedComputeFamily = QueueFamilyIndices::findDedicatedComputeFamily(queueFamilies);
+    indices.dedicatedTransferFamily = QueueFamilyIndices::findDedicatedTransferFamily(queueFamilies);
+
     return indices;
 }
 
@@ -1323,7 +1506,7 @@ void GpuDeviceInitializer::createDummySurface() {
 }
 
 void GpuDeviceInitializer::selectPhysicalDevice() {
-    const auto physicalDeviceSpecProvider = PhysicalDeviceSpecProvider {};
+    const auto physicalDeviceSpecProvider = PhysicalDeviceSpecProvider { !m_enableHeadless };
     const auto physicalDeviceSpec = physicalDeviceSpecProvider.createPhysicalDeviceSpec();
     
     auto infoProvider = std::make_unique<PlatformInfoProvider>();
@@ -1344,11 +1527,12 @@ void GpuDeviceInitializer::createLogicalDevice() {
     auto infoProvider = std::make_unique<PlatformInfoProvider>();
     auto factory = LogicalDeviceFactory { m_physicalDevice, m_dummySurface, std::move(infoProvider) };
     
-    const auto [device, graphicsQueue, computeQueue, presentQueue] = factory.createLogicalDevice(logicalDeviceSpec);
+    const auto [device, graphicsQueue, computeQueue, transferQueue, presentQueue] = factory.createLogicalDevice(logicalDeviceSpec);
 
     m_device = device;
     m_graphicsQueue = graphicsQueue;
     m_computeQueue = computeQueue;
+    m_transferQueue = transferQueue;
     m_presentQueue = presentQueue;
 }
 
@@ -1366,7 +1550,44 @@ void GpuDeviceInitializer::createCommandPool() {
         throw std::runtime_error("failed to create command pool!");
     }
 
+    // Command buffers can only be submitted to queues of the family their pool was created for.
+    auto computeCommandPool = commandPool;
+    if (queueFamilyIndices.hasDedicatedComputeFamily()) {
+        const auto computePoolInfo = VkCommandPoolCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = queueFamilyIndices.getComputeFamily(),
+        };
+
+        const auto resultCompute = vkCreateCommandPool(m_device, &computePoolInfo, nullptr, &computeCommandPool);
+        if (resultCompute != VK_SUCCESS) {
+            vkDestroyCommandPool(m_device, commandPool, nullptr);
+            throw std::runtime_error("failed to create compute command pool!");
+        }
+    }
+
+    auto transferCommandPool = commandPool;
+    if (queueFamilyIndices.hasDedicatedTransferFamily()) {
+        const auto transferPoolInfo = VkCommandPoolCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = queueFamilyIndices.getTransferFamily(),
+        };
+
+        const auto resultTransfer = vkCreateCommandPool(m_device, &transferPoolInfo, nullptr, &transferCommandPool);
+        if (resultTransfer != VK_SUCCESS) {
+            if (computeCommandPool != commandPool) {
+                vkDestroyCommandPool(m_device, computeCommandPool, nullptr);
+            }
+            vkDestroyCommandPool(m_device, commandPool, nullptr);
+            throw std::runtime_error("failed to create transfer command pool!");
+        }
+    }
+
     m_commandPool = commandPool;
+    m_computeCommandPool = computeCommandPool;
+    m_transferCommandPool = transferCommandPool;
+    m_queueFamilyIndices = queueFamilyIndices;
 }
 
 
@@ -1382,15 +1603,21 @@ Engine::~Engine() {
     m_systemFactory.reset();
     m_infoProvider.reset();
 
-    glfwTerminate();
+    if (!m_enableHeadless) {
+        glfwTerminate();
+    }
 }
 
 std::unique_ptr<Engine> Engine::createDebugMode() {
-    return Engine::create(true);
+    return Engine::create(true, false);
 }
 
 std::unique_ptr<Engine> Engine::createReleaseMode() {
-    return Engine::create(false);
+    return Engine::create(false, false);
+}
+
+std::unique_ptr<Engine> Engine::createHeadless() {
+    return Engine::create(ENABLE_VALIDATION_LAYERS, true);
 }
 
 VkInstance Engine::getInstance() const {
@@ -1413,6 +1640,10 @@ VkQueue Engine::getComputeQueue() const {
     return m_gpuDevice->getComputeQueue();
 }
 
+VkQueue Engine::getTransferQueue() const {
+    return m_gpuDevice->getTransferQueue();
+}
+
 VkQueue Engine::getPresentQueue() const {
     return m_gpuDevice->getPresentQueue();
 }
@@ -1421,6 +1652,18 @@ VkCommandPool Engine::getCommandPool() const {
     return m_gpuDevice->getCommandPool();
 }
 
+VkCommandPool Engine::getComputeCommandPool() const {
+    return m_gpuDevice->getComputeCommandPool();
+}
+
+VkCommandPool Engine::getTransferCommandPool() const {
+    return m_gpuDevice->getTransferCommandPool();
+}
+
+const QueueFamilyIndices& Engine::getQueueFamilyIndices() const {
+    return m_gpuDevice->getQueueFamilyIndices();
+}
+
 VkSurfaceKHR Engine::getSurface() const {
     return m_surface;
 }
@@ -1445,6 +1688,10 @@ bool Engine::isInitialized() const {
     return m_instance != VK_NULL_HANDLE;
 }
 
+bool Engine::isHeadless() const {
+    return m_enableHeadless;
+}
+
 void Engine::createGLFWLibrary() {
     const auto result = glfwInit();
     if (!result) {
@@ -1469,7 +1716,11 @@ void Engine::createSystemFactory() {
 }
 
 void Engine::createInstance() {
-    const auto instanceSpecProvider = InstanceSpecProvider { m_enableValidationLayers, m_enableDebuggingExtensions };
+    const auto instanceSpecProvider = InstanceSpecProvider { 
+        m_enableValidationLayers,
+        m_enableDebuggingExtensions,
+        !m_enableHeadless
+    };
     const auto instanceSpec = instanceSpecProvider.createInstanceSpec();
     const auto instance = m_systemFactory->create(instanceSpec);
         
@@ -1493,13 +1744,17 @@ void Engine::createDebugMessenger() {
 }
 
 void Engine::createWindow(uint32_t width, uint32_t height, const std::string& title) {
+    if (m_enableHeadless) {
+        throw std::runtime_error("cannot create a window with a headless engine!");
+    }
+
     m_windowSystem->createWindow(width, height, title);
        
     this->createRenderSurface();
 }
 
 void Engine::createGpuDevice() {
-    auto gpuDeviceInitializer = GpuDeviceInitializer { m_instance };
+    auto gpuDeviceInitializer = GpuDeviceInitializer { m_instance, m_enableHeadless };
     auto gpuDevice = gpuDeviceInitializer.createGpuDevice();
 
     m_gpuDevice = std::move(gpuDevice);
@@ -1527,6 +1782,16 @@ QueueFamilyIndices Engine::findQueueFamilies(VkPhysicalDevice physicalDevice, Vk
             indices.graphicsAndComputeFamily = i;
         }
 
+        // A headless device has no surface to present to, so only the compute side needs to be found.
+        if (surface == VK_NULL_HANDLE) {
+            if (indices.isCompleteHeadless()) {
+                break;
+            }
+
+            i++;
+            continue;
+        }
+
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
 
@@ -1541,6 +1806,9 @@ QueueFamilyIndices Engine::findQueueFamilies(VkPhysicalDevice physicalDevice, Vk
         i++;
     }
 
+    indices.dedicatedComputeFamily = QueueFamilyIndices::findDedicatedComputeFamily(queueFamilies);
+    indices.dedicatedTransferFamily = QueueFamilyIndices::findDedicatedTransferFamily(queueFamilies);
+
     return indices;
 }
 
@@ -1583,8 +1851,49 @@ VkShaderModule Engine::createShaderModule(const std::vector<unsigned char>& code
     return m_gpuDevice->createShaderModule(code);
 }
 
-std::unique_ptr<Engine> Engine::create(bool enableDebugging) {
+VkShaderModule Engine::createShaderModule(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    return m_gpuDevice->createShaderModule(code, codeLifetime);
+}
+
+void Engine::releaseShaderModule(VkShaderModule shaderModule) {
+    m_gpuDevice->releaseShaderModule(shaderModule);
+}
+
+void Engine::evictUnusedShaderModules() {
+    m_gpuDevice->evictUnusedShaderModules();
+}
+
+ShaderModuleCacheStats Engine::getShaderModuleCacheStats() const {
+    return m_gpuDevice->getShaderModuleCacheStats();
+}
+
+const ShaderReflection& Engine::reflectShader(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    return m_gpuDevice->reflectShader(code, codeLifetime);
+}
+
+MemoryAllocation Engine::allocateMemory(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties) {
+    return m_gpuDevice->allocateMemory(memoryRequirements, properties);
+}
+
+void Engine::freeMemory(const MemoryAllocation& allocation) {
+    m_gpuDevice->freeMemory(allocation);
+}
+
+MemoryStats Engine::getMemoryStats() const {
+    return m_gpuDevice->getMemoryStats();
+}
+
+PipelineCache& Engine::getPipelineCache() {
+    return m_gpuDevice->getPipelineCache();
+}
+
+void Engine::loadPipelineCache(const std::filesystem::path& filePath) {
+    m_gpuDevice->loadPipelineCache(filePath);
+}
+
+std::unique_ptr<Engine> Engine::create(bool enableDebugging, bool enableHeadless) {
     auto newEngine = std::make_unique<Engine>();
+    newEngine->m_enableHeadless = enableHeadless;
 
     if (enableDebugging) {
         newEngine->m_enableValidationLayers = true;
@@ -1594,13 +1903,19 @@ std::unique_ptr<Engine> Engine::create(bool enableDebugging) {
         newEngine->m_enableDebuggingExtensions = false;
     }
 
-    newEngine->createGLFWLibrary();
+    if (!enableHeadless) {
+        newEngine->createGLFWLibrary();
+    }
+
     newEngine->createInfoProvider();
     newEngine->createSystemFactory();
     newEngine->createInstance();
     newEngine->createDebugMessenger();
     newEngine->createGpuDevice();
-    newEngine->createWindowSystem();
+
+    if (!enableHeadless) {
+        newEngine->createWindowSystem();
+    }
 
     return newEngine;
 }
@@ -3,7 +3,15 @@
 
 #include <vulkan/vulkan.h>
 
+#include "mapped_file.h"
+#include "memory_allocator.h"
+#include "pipeline_cache.h"
+#include "shader_module_cache.h"
+#include "shader_reflection.h"
+
+#include <filesystem>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <vector>
 #include <optional>
@@ -134,10 +142,58 @@ class PlatformInfoProvider {
 struct QueueFamilyIndices final {
     std::optional<uint32_t> graphicsAndComputeFamily;
     std::optional<uint32_t> presentFamily;
+    // A family with compute but without graphics support. Work submitted to it runs alongside the 
+    // graphics queue instead of being serialized with it.
+    std::optional<uint32_t> dedicatedComputeFamily;
+    // A family with transfer but neither graphics nor compute support, usually backed by a DMA engine
+    // that copies without taking any time away from the shader cores.
+    std::optional<uint32_t> dedicatedTransferFamily;
 
     bool isComplete() const {
         return graphicsAndComputeFamily.has_value() && presentFamily.has_value();
     }
+
+    bool isCompleteHeadless() const {
+        return graphicsAndComputeFamily.has_value();
+    }
+
+    bool hasDedicatedComputeFamily() const {
+        return dedicatedComputeFamily.has_value() && dedicatedComputeFamily != graphicsAndComputeFamily;
+    }
+
+    uint32_t getComputeFamily() const {
+        return dedicatedComputeFamily.value_or(graphicsAndComputeFamily.value());
+    }
+
+    bool hasDedicatedTransferFamily() const {
+        return dedicatedTransferFamily.has_value() && dedicatedTransferFamily != graphicsAndComputeFamily;
+    }
+
+    uint32_t getTransferFamily() const {
+        return dedicatedTransferFamily.value_or(graphicsAndComputeFamily.value());
+    }
+
+    static std::optional<uint32_t> findDedicatedComputeFamily(const std::vector<VkQueueFamilyProperties>& queueFamilies) {
+        for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+            const auto queueFlags = queueFamilies[i].queueFlags;
+            if ((queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    static std::optional<uint32_t> findDedicatedTransferFamily(const std::vector<VkQueueFamilyProperties>& queueFamilies) {
+        for (uint32_t i = 0; i < queueFamilies.size(); i++) {
+            const auto queueFlags = queueFamilies[i].queueFlags;
+            if ((queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
 };
 
 struct SwapChainSupportDetails final {
@@ -181,6 +237,7 @@ class InstanceSpecProvider final {
     public:
         explicit InstanceSpecProvider() = default;
         explicit InstanceSpecProvider(bool enableValidationLayers, bool enableDebuggingExtensions);
+        explicit InstanceSpecProvider(bool enableValidationLayers, bool enableDebuggingExtensions, bool enableWindowSystem);
 
         ~InstanceSpecProvider();
 
@@ -188,6 +245,7 @@ class InstanceSpecProvider final {
     private:
         bool m_enableValidationLayers;
         bool m_enableDebuggingExtensions;
+        bool m_enableWindowSystem;
 
         enum class Platform {
             Apple,
@@ -249,9 +307,12 @@ class PhysicalDeviceSpec final {
 class PhysicalDeviceSpecProvider final {
     public:
         explicit PhysicalDeviceSpecProvider() = default;
+        explicit PhysicalDeviceSpecProvider(bool requirePresentFamily);
 
         PhysicalDeviceSpec createPhysicalDeviceSpec() const;
     private:
+        bool m_requirePresentFamily = true;
+
         enum class Platform {
             Apple,
             Linux,
@@ -284,6 +345,9 @@ class PhysicalDeviceSelector final {
 
         bool checkDeviceExtensionSupport(VkPhysicalDevice physicalDevice, const std::vector<std::string>& requiredExtensions) const;
 
+        // Timeline semaphores and host query resets, which every Vulkan 1.2 device supports.
+        bool checkVulkan12FeatureSupport(VkPhysicalDevice physicalDevice) const;
+
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) const;
 
         bool isPhysicalDeviceCompatible(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, const PhysicalDeviceSpec& physicalDeviceSpec) const;
@@ -357,7 +421,7 @@ class LogicalDeviceFactory final {
 
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) const;
 
-        std::tuple<VkDevice, VkQueue, VkQueue, VkQueue> createLogicalDevice(const LogicalDeviceSpec& logicalDeviceSpec);
+        std::tuple<VkDevice, VkQueue, VkQueue, VkQueue, VkQueue> createLogicalDevice(const LogicalDeviceSpec& logicalDeviceSpec);
     private:
         VkPhysicalDevice m_physicalDevice;
         VkSurfaceKHR m_surface;
@@ -454,8 +518,12 @@ class GpuDevice final {
             VkDevice device, 
             VkQueue graphicsQueue,
             VkQueue computeQueue,
+            VkQueue transferQueue,
             VkQueue presentQueue,
-            VkCommandPool commandPool
+            VkCommandPool commandPool,
+            VkCommandPool computeCommandPool,
+            VkCommandPool transferCommandPool,
+            QueueFamilyIndices queueFamilyIndices
         );
 
         ~GpuDevice();
@@ -468,10 +536,18 @@ class GpuDevice final {
 
         VkQueue getComputeQueue() const;
 
+        VkQueue getTransferQueue() const;
+
         VkQueue getPresentQueue() const;
 
         VkCommandPool getCommandPool() const;
 
+        VkCommandPool getComputeCommandPool() const;
+
+        VkCommandPool getTransferCommandPool() const;
+
+        const QueueFamilyIndices& getQueueFamilyIndices() const;
+
         VkSampleCountFlagBits getMsaaSamples() const;
 
         static VkSampleCountFlagBits getMaxUsableSampleCount(VkPhysicalDevice physicalDevice);
@@ -485,24 +561,57 @@ class GpuDevice final {
         VkShaderModule createShaderModule(const std::vector<char>& code);
 
         VkShaderModule createShaderModule(const std::vector<unsigned char>& code);
+
+        // Returns the cached module for the code when there is one, and takes a reference to it either way.
+        VkShaderModule createShaderModule(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+
+        // Gives back a reference taken by `createShaderModule`. The module stays cached until it is evicted.
+        void releaseShaderModule(VkShaderModule shaderModule);
+
+        void evictUnusedShaderModules();
+
+        ShaderModuleCacheStats getShaderModuleCacheStats() const;
+
+        // Reflects the descriptor sets and push constants of the code, once per distinct binary.
+        const ShaderReflection& reflectShader(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+
+        MemoryAllocation allocateMemory(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties);
+
+        void freeMemory(const MemoryAllocation& allocation);
+
+        MemoryStats getMemoryStats() const;
+
+        PipelineCache& getPipelineCache();
+
+        // Replaces the in-memory pipeline cache the device starts out with by one persisted in `filePath`.
+        // Pipelines created before keep working, but their binaries are not carried over.
+        void loadPipelineCache(const std::filesystem::path& filePath);
     private:
         VkInstance m_instance;
         VkPhysicalDevice m_physicalDevice;
         VkDevice m_device;
         VkQueue m_graphicsQueue;
         VkQueue m_computeQueue;
+        VkQueue m_transferQueue;
         VkQueue m_presentQueue;
         VkCommandPool m_commandPool;
-        VkSurfaceKHR m_surface;
+        VkCommandPool m_computeCommandPool;
+        VkCommandPool m_transferCommandPool;
+        QueueFamilyIndices m_queueFamilyIndices;
+        VkSurfaceKHR m_surface = VK_NULL_HANDLE;
         VkSampleCountFlagBits m_msaaSamples = VK_SAMPLE_COUNT_1_BIT;
 
-        std::unordered_set<VkShaderModule> m_shaderModules;
+        std::unique_ptr<ShaderModuleCache> m_shaderModuleCache;
+        std::unique_ptr<ShaderReflectionCache> m_shaderReflectionCache;
+        std::unique_ptr<MemoryAllocator> m_memoryAllocator;
+        std::unique_ptr<PipelineCache> m_pipelineCache;
 
         std::vector<char> loadShader(std::istream& stream);
 
-        std::ifstream openShaderFile(const std::string& fileName);
+        // Maps the file rather than reading it, so its code reaches the shader module cache without a copy.
+        MappedFile loadShaderFromFile(const std::string& fileName);
 
-        std::vector<char> loadShaderFromFile(const std::string& fileName);
+        static std::span<const uint32_t> getShaderCodeWords(const void* code, size_t codeSize);
 
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 };
@@ -510,19 +619,25 @@ class GpuDevice final {
 class GpuDeviceInitializer final {
     public:
         explicit GpuDeviceInitializer(VkInstance instance);
+        explicit GpuDeviceInitializer(VkInstance instance, bool enableHeadless);
 
         ~GpuDeviceInitializer();
 
         std::unique_ptr<GpuDevice> createGpuDevice();
     private:
         VkInstance m_instance;
+        bool m_enableHeadless;
         VkSurfaceKHR m_dummySurface;
         VkPhysicalDevice m_physicalDevice;
         VkDevice m_device;
         VkQueue m_graphicsQueue;
         VkQueue m_computeQueue;
+        VkQueue m_transferQueue;
         VkQueue m_presentQueue;
         VkCommandPool m_commandPool;
+        VkCommandPool m_computeCommandPool;
+        VkCommandPool m_transferCommandPool;
+        QueueFamilyIndices m_queueFamilyIndices;
 
         QueueFamilyIndices findQueueFamilies(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) const;
 
@@ -544,6 +659,8 @@ class Engine final {
 
         static std::unique_ptr<Engine> createReleaseMode();
 
+        static std::unique_ptr<Engine> createHeadless();
+
         VkInstance getInstance() const;
 
         VkPhysicalDevice getPhysicalDevice() const;
@@ -554,10 +671,18 @@ class Engine final {
 
         VkQueue getComputeQueue() const;
 
+        VkQueue getTransferQueue() const;
+
         VkQueue getPresentQueue() const;
 
         VkCommandPool getCommandPool() const;
 
+        VkCommandPool getComputeCommandPool() const;
+
+        VkCommandPool getTransferCommandPool() const;
+
+        const QueueFamilyIndices& getQueueFamilyIndices() const;
+
         VkSurfaceKHR getSurface() const;
 
         VkSampleCountFlagBits getMsaaSamples() const;
@@ -570,6 +695,8 @@ class Engine final {
 
         bool isInitialized() const;
 
+        bool isHeadless() const;
+
         void createGLFWLibrary();
 
         void createInfoProvider();
@@ -599,20 +726,41 @@ class Engine final {
         VkShaderModule createShaderModule(const std::vector<char>& code);
 
         VkShaderModule createShaderModule(const std::vector<unsigned char>& code);
+
+        VkShaderModule createShaderModule(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+
+        void releaseShaderModule(VkShaderModule shaderModule);
+
+        void evictUnusedShaderModules();
+
+        ShaderModuleCacheStats getShaderModuleCacheStats() const;
+
+        const ShaderReflection& reflectShader(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+
+        MemoryAllocation allocateMemory(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties);
+
+        void freeMemory(const MemoryAllocation& allocation);
+
+        MemoryStats getMemoryStats() const;
+
+        PipelineCache& getPipelineCache();
+
+        void loadPipelineCache(const std::filesystem::path& filePath);
     private:
         std::unique_ptr<PlatformInfoProvider> m_infoProvider;
         std::unique_ptr<SystemFactory> m_systemFactory;
         VkInstance m_instance;
         std::unique_ptr<VulkanDebugMessenger> m_debugMessenger;
         std::unique_ptr<WindowSystem> m_windowSystem;
-        VkSurfaceKHR m_surface;
+        VkSurfaceKHR m_surface = VK_NULL_HANDLE;
 
         std::unique_ptr<GpuDevice> m_gpuDevice;
 
         bool m_enableValidationLayers; 
         bool m_enableDebuggingExtensions;
+        bool m_enableHeadless = false;
 
-        static std::unique_ptr<Engine> create(bool enableDebugging);
+        static std::unique_ptr<Engine> create(bool enableDebugging, bool enableHeadless);
 };
 
 }
@@ -0,0 +1,401 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <thread>
+
+
+using FrameScheduler = VulkanEngine::FrameScheduler;
+using FramePacing = VulkanEngine::FramePacing;
+using FramePacingStats = VulkanEngine::FramePacingStats;
+
+double FramePacingStats::getFramesPerSecond() const {
+    if (elapsedSeconds <= 0.0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(frameCount) / elapsedSeconds;
+}
+
+FrameScheduler::FrameScheduler(
+    Engine& engine,
+    uint32_t frameSlotCount,
+    uint32_t framesInFlight,
+    FramePacing pacing,
+    double targetFrameRate
+)
+    : m_engine { engine }
+    , m_frameSlotCount { frameSlotCount }
+    , m_framesInFlight { framesInFlight }
+    , m_pacing { pacing }
+    , m_targetFramePeriod {}
+    , m_hasGraphics { !engine.isHeadless() }
+    , m_computeTimeline { VK_NULL_HANDLE }
+    , m_graphicsTimeline { VK_NULL_HANDLE }
+    , m_imageAvailableSemaphores {}
+    , m_renderFinishedSemaphores {}
+    , m_frameNumber { 1 }
+    , m_computeValue { 0 }
+    , m_graphicsValue { 0 }
+    , m_nextFrameDeadline {}
+    , m_pendingFrames {}
+    , m_firstFrameStartTime {}
+    , m_lastRetireTime {}
+    , m_retiredFrameCount { 0 }
+    , m_totalLatency { Clock::duration::zero() }
+    , m_maxLatency { Clock::duration::zero() }
+{
+    if (framesInFlight == 0) {
+        throw std::invalid_argument("a frame scheduler needs at least one frame in flight!");
+    }
+
+    if (frameSlotCount < framesInFlight) {
+        throw std::invalid_argument("a frame scheduler needs a frame slot for every frame in flight!");
+    }
+
+    if (pacing == FramePacing::FixedRate) {
+        if (targetFrameRate <= 0.0) {
+            throw std::invalid_argument("fixed rate frame pacing needs a positive frame rate!");
+        }
+
+        m_targetFramePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double> { 1.0 / targetFrameRate });
+    }
+
+    m_computeTimeline = this->createTimelineSemaphore();
+    m_graphicsTimeline = this->createTimelineSemaphore();
+
+    if (m_hasGraphics) {
+        for (uint32_t i = 0; i < frameSlotCount; i++) {
+            m_imageAvailableSemaphores.push_back(this->createBinarySemaphore());
+            m_renderFinishedSemaphores.push_back(this->createBinarySemaphore());
+        }
+    }
+}
+
+FrameScheduler::~FrameScheduler() {
+    this->waitIdle();
+
+    for (size_t i = 0; i < m_imageAvailableSemaphores.size(); i++) {
+        vkDestroySemaphore(m_engine.getLogicalDevice(), m_imageAvailableSemaphores[i], nullptr);
+        vkDestroySemaphore(m_engine.getLogicalDevice(), m_renderFinishedSemaphores[i], nullptr);
+    }
+
+    vkDestroySemaphore(m_engine.getLogicalDevice(), m_graphicsTimeline, nullptr);
+    vkDestroySemaphore(m_engine.getLogicalDevice(), m_computeTimeline, nullptr);
+
+    m_imageAvailableSemaphores.clear();
+    m_renderFinishedSemaphores.clear();
+}
+
+uint64_t FrameScheduler::getFrameNumber() const {
+    return m_frameNumber;
+}
+
+uint32_t FrameScheduler::getFrameIndex() const {
+    return static_cast<uint32_t>((m_frameNumber - 1) % m_frameSlotCount);
+}
+
+uint32_t FrameScheduler::getFrameSlotCount() const {
+    return m_frameSlotCount;
+}
+
+uint32_t FrameScheduler::getFramesInFlight() const {
+    return m_framesInFlight;
+}
+
+FramePacing FrameScheduler::getPacing() const {
+    return m_pacing;
+}
+
+void FrameScheduler::beginFrame() {
+    this->retireFinishedFrames();
+
+    // With as many frames in flight as slots, waiting for a slot already limits the frames in flight.
+    const bool limitsFramesInFlight = (m_pacing != FramePacing::Throughput) || (m_framesInFlight < m_frameSlotCount);
+    if (limitsFramesInFlight && m_frameNumber > m_framesInFlight) {
+        this->waitForValue(this->getRetireTimeline(), m_frameNumber - m_framesInFlight);
+        this->retireFinishedFrames();
+    }
+
+    if (m_pacing == FramePacing::FixedRate) {
+        const auto now = Clock::now();
+        if (now < m_nextFrameDeadline) {
+            std::this_thread::sleep_until(m_nextFrameDeadline);
+        }
+
+        // A frame that starts late pushes back the ones after it, rather than them trying to catch up.
+        m_nextFrameDeadline = std::max(m_nextFrameDeadline, now) + m_targetFramePeriod;
+    }
+
+    const auto startTime = Clock::now();
+    if (m_frameNumber == 1) {
+        m_firstFrameStartTime = startTime;
+    }
+
+    m_pendingFrames.push_back(PendingFrame { m_frameNumber, startTime });
+}
+
+VkSemaphore FrameScheduler::getImageAvailableSemaphore() const {
+    return m_imageAvailableSemaphores[this->getFrameIndex()];
+}
+
+VkSemaphore FrameScheduler::getRenderFinishedSemaphore() const {
+    return m_renderFinishedSemaphores[this->getFrameIndex()];
+}
+
+void FrameScheduler::waitForComputeSlot() {
+    this->waitForValue(m_computeTimeline, this->getRecycledFrameNumber());
+}
+
+void FrameScheduler::waitForGraphicsSlot() {
+    if (m_hasGraphics) {
+        this->waitForValue(m_graphicsTimeline, this->getRecycledFrameNumber());
+    }
+}
+
+void FrameScheduler::submitCompute(VkCommandBuffer commandBuffer) {
+    // Without a graphics pass nothing reads the vertex buffers, and the graphics timeline never advances.
+    const uint64_t recycledFrameNumber = this->getRecycledFrameNumber();
+    const uint32_t waitSemaphoreCount = [this, recycledFrameNumber]() -> uint32_t {
+        if (m_hasGraphics && recycledFrameNumber > 0) {
+            return 1;
+        } else {
+            return 0;
+        }
+    }();
+
+    const auto waitSemaphores = std::array<VkSemaphore, 1> { m_graphicsTimeline };
+    const auto waitValues = std::array<uint64_t, 1> { recycledFrameNumber };
+    const auto waitStages = std::array<VkPipelineStageFlags, 1> { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+    const auto signalSemaphores = std::array<VkSemaphore, 1> { m_computeTimeline };
+    const auto signalValues = std::array<uint64_t, 1> { m_frameNumber };
+
+    const auto timelineSubmitInfo = VkTimelineSemaphoreSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount = waitSemaphoreCount,
+        .pWaitSemaphoreValues = waitValues.data(),
+        .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+        .pSignalSemaphoreValues = signalValues.data(),
+    };
+
+    const auto submitInfo = VkSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineSubmitInfo,
+        .waitSemaphoreCount = waitSemaphoreCount,
+        .pWaitSemaphores = waitSemaphores.data(),
+        .pWaitDstStageMask = waitStages.data(),
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+        .pSignalSemaphores = signalSemaphores.data(),
+    };
+
+    const auto result = vkQueueSubmit(m_engine.getComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit compute command buffer!");
+    }
+
+    m_computeValue = m_frameNumber;
+}
+
+void FrameScheduler::signalComputeFromHost() {
+    const auto signalInfo = VkSemaphoreSignalInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+        .semaphore = m_computeTimeline,
+        .value = m_frameNumber,
+    };
+
+    const auto result = vkSignalSemaphore(m_engine.getLogicalDevice(), &signalInfo);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to signal compute timeline semaphore!");
+    }
+
+    m_computeValue = m_frameNumber;
+}
+
+void FrameScheduler::submitGraphics(VkCommandBuffer commandBuffer) {
+    this->submitGraphicsBatch(commandBuffer, true);
+}
+
+void FrameScheduler::skipGraphics() {
+    // Later steps still wait for this frame's value before they overwrite its vertex buffer.
+    this->submitGraphicsBatch(VK_NULL_HANDLE, false);
+}
+
+void FrameScheduler::advance() {
+    m_frameNumber++;
+}
+
+void FrameScheduler::waitIdle() {
+    this->waitForValue(m_computeTimeline, m_computeValue);
+    this->waitForValue(m_graphicsTimeline, m_graphicsValue);
+
+    this->retireFinishedFrames();
+}
+
+FramePacingStats FrameScheduler::getPacingStats() const {
+    if (m_retiredFrameCount == 0) {
+        return FramePacingStats {};
+    }
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    using Seconds = std::chrono::duration<double>;
+
+    return FramePacingStats {
+        .frameCount = m_retiredFrameCount,
+        .elapsedSeconds = Seconds { m_lastRetireTime - m_firstFrameStartTime }.count(),
+        .averageLatencyMilliseconds = Milliseconds { m_totalLatency }.count() / static_cast<double>(m_retiredFrameCount),
+        .maxLatencyMilliseconds = Milliseconds { m_maxLatency }.count(),
+    };
+}
+
+uint64_t FrameScheduler::getRecycledFrameNumber() const {
+    if (m_frameNumber > m_frameSlotCount) {
+        return m_frameNumber - m_frameSlotCount;
+    } else {
+        return 0;
+    }
+}
+
+bool FrameScheduler::isFrameFinished(uint64_t frameNumber) const {
+    uint64_t finishedValue = 0;
+    const auto result = vkGetSemaphoreCounterValue(m_engine.getLogicalDevice(), this->getRetireTimeline(), &finishedValue);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to read timeline semaphore value!");
+    }
+
+    return frameNumber <= finishedValue;
+}
+
+VkSemaphore FrameScheduler::getRetireTimeline() const {
+    if (m_hasGraphics) {
+        return m_graphicsTimeline;
+    } else {
+        return m_computeTimeline;
+    }
+}
+
+void FrameScheduler::retireFinishedFrames() {
+    if (m_pendingFrames.empty()) {
+        return;
+    }
+
+    uint64_t finishedValue = 0;
+    const auto result = vkGetSemaphoreCounterValue(m_engine.getLogicalDevice(), this->getRetireTimeline(), &finishedValue);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to read timeline semaphore value!");
+    }
+
+    const auto now = Clock::now();
+    while (!m_pendingFrames.empty() && m_pendingFrames.front().frameNumber <= finishedValue) {
+        const auto latency = now - m_pendingFrames.front().startTime;
+        m_totalLatency += latency;
+        m_maxLatency = std::max(m_maxLatency, latency);
+        m_retiredFrameCount++;
+        m_lastRetireTime = now;
+
+        m_pendingFrames.pop_front();
+    }
+}
+
+void FrameScheduler::waitForValue(VkSemaphore timeline, uint64_t value) {
+    // Every timeline starts out at zero.
+    if (value == 0) {
+        return;
+    }
+
+    const auto waitInfo = VkSemaphoreWaitInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &timeline,
+        .pValues = &value,
+    };
+
+    const auto result = vkWaitSemaphores(m_engine.getLogicalDevice(), &waitInfo, UINT64_MAX);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+}
+
+void FrameScheduler::submitGraphicsBatch(VkCommandBuffer commandBuffer, bool isPresenting) {
+    // The frame draws the particles of its own step. Binary semaphores ignore their timeline values.
+    const auto waitSemaphores = std::array<VkSemaphore, 2> {
+        m_computeTimeline,
+        m_imageAvailableSemaphores[this->getFrameIndex()]
+    };
+    const auto waitValues = std::array<uint64_t, 2> { m_frameNumber, 0 };
+    // A skipped frame acquired no image and records nothing, so it only takes part in the timelines.
+    const auto waitStages = std::array<VkPipelineStageFlags, 2> {
+        isPresenting ? VK_PIPELINE_STAGE_VERTEX_INPUT_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+    };
+    const auto signalSemaphores = std::array<VkSemaphore, 2> {
+        m_graphicsTimeline,
+        m_renderFinishedSemaphores[this->getFrameIndex()]
+    };
+    const auto signalValues = std::array<uint64_t, 2> { m_frameNumber, 0 };
+    const uint32_t semaphoreCount = isPresenting ? 2 : 1;
+    const uint32_t commandBufferCount = isPresenting ? 1 : 0;
+
+    const auto timelineSubmitInfo = VkTimelineSemaphoreSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount = semaphoreCount,
+        .pWaitSemaphoreValues = waitValues.data(),
+        .signalSemaphoreValueCount = semaphoreCount,
+        .pSignalSemaphoreValues = signalValues.data(),
+    };
+
+    const auto submitInfo = VkSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineSubmitInfo,
+        .waitSemaphoreCount = semaphoreCount,
+        .pWaitSemaphores = waitSemaphores.data(),
+        .pWaitDstStageMask = waitStages.data(),
+        .commandBufferCount = commandBufferCount,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = semaphoreCount,
+        .pSignalSemaphores = signalSemaphores.data(),
+    };
+
+    const auto result = vkQueueSubmit(m_engine.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit draw command buffer!");
+    }
+
+    m_graphicsValue = m_frameNumber;
+}
+
+VkSemaphore FrameScheduler::createTimelineSemaphore() {
+    const auto typeInfo = VkSemaphoreTypeCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+    const auto semaphoreInfo = VkSemaphoreCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &typeInfo,
+    };
+
+    auto semaphore = VkSemaphore {};
+    const auto result = vkCreateSemaphore(m_engine.getLogicalDevice(), &semaphoreInfo, nullptr, &semaphore);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timeline semaphore!");
+    }
+
+    return semaphore;
+}
+
+VkSemaphore FrameScheduler::createBinarySemaphore() {
+    const auto semaphoreInfo = VkSemaphoreCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    };
+
+    auto semaphore = VkSemaphore {};
+    const auto result = vkCreateSemaphore(m_engine.getLogicalDevice(), &semaphoreInfo, nullptr, &semaphore);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create semaphore for a frame!");
+    }
+
+    return semaphore;
+}
@@ -0,0 +1,158 @@
+#ifndef _FRAME_SCHEDULER_H
+#define _FRAME_SCHEDULER_H
+
+#include <vulkan/vulkan.h>
+
+#include "engine.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+enum class FramePacing {
+    // Waits for a frame slot before the frame samples its input, so the input is as fresh as it can be
+    // when the frame is submitted.
+    LowLatency,
+    // Only waits once the resources of a frame slot are about to be reused, which keeps the queues as
+    // deep as the frames in flight allow.
+    Throughput,
+    // Paces like `LowLatency`, and then starts frames no faster than a fixed rate.
+    FixedRate
+};
+
+struct FramePacingStats final {
+    uint64_t frameCount = 0;
+    double elapsedSeconds = 0.0;
+    // The time from the start of a frame to the host noticing it has finished on the device.
+    double averageLatencyMilliseconds = 0.0;
+    double maxLatencyMilliseconds = 0.0;
+
+    double getFramesPerSecond() const;
+};
+
+// Paces simulation steps and frames with one timeline semaphore per queue instead of per frame fences.
+//
+// Frames are numbered from one. Compute step `n` signals the compute timeline with `n`, and frame `n`
+// signals the graphics timeline with `n`, so each timeline counts the work its queue has finished. The
+// resources of a frame are recycled every `frameSlotCount` frames, which gives the only dependencies:
+//
+// - Frame `n` draws what compute step `n` wrote, so its submission waits for compute value `n`.
+// - Compute step `n` overwrites the vertex buffer frame `n - frameSlotCount` drew from, so its
+//   submission waits for graphics value `n - frameSlotCount`.
+// - The host rerecords a command buffer and rewrites a uniform buffer only once the step or frame that
+//   last used them has finished.
+//
+// All waits between the queues happen on the device, so compute can run up to `frameSlotCount` steps
+// ahead of graphics. On top of that, `beginFrame` keeps at most `framesInFlight` frames unfinished,
+// waiting where the pacing mode asks for it. The simulation ping-pongs between the particle buffers of
+// consecutive slots, so a single frame in flight still takes two slots. Swap chain image acquisition
+// and presentation only take binary semaphores, so each slot keeps a pair of those.
+class FrameScheduler final {
+    public:
+        explicit FrameScheduler(
+            Engine& engine,
+            uint32_t frameSlotCount,
+            uint32_t framesInFlight,
+            FramePacing pacing,
+            double targetFrameRate
+        );
+
+        ~FrameScheduler();
+
+        FrameScheduler(const FrameScheduler&) = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        uint64_t getFrameNumber() const;
+
+        uint32_t getFrameIndex() const;
+
+        uint32_t getFrameSlotCount() const;
+
+        uint32_t getFramesInFlight() const;
+
+        FramePacing getPacing() const;
+
+        // Paces the start of the current frame, which should come right before the frame samples its input.
+        void beginFrame();
+
+        VkSemaphore getImageAvailableSemaphore() const;
+
+        VkSemaphore getRenderFinishedSemaphore() const;
+
+        // Blocks until the compute step that last used this frame's compute resources has finished.
+        void waitForComputeSlot();
+
+        // Blocks until the frame that last used this frame's graphics resources has finished.
+        void waitForGraphicsSlot();
+
+        void submitCompute(VkCommandBuffer commandBuffer);
+
+        // Marks the current step as finished for a simulation that ran on the host.
+        void signalComputeFromHost();
+
+        void submitGraphics(VkCommandBuffer commandBuffer);
+
+        // Retires the current frame without drawing it, for when no swap chain image could be acquired.
+        void skipGraphics();
+
+        void advance();
+
+        // Whether frame `frameNumber` and every frame before it have finished on the device, without blocking.
+        bool isFrameFinished(uint64_t frameNumber) const;
+
+        void waitIdle();
+
+        FramePacingStats getPacingStats() const;
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct PendingFrame final {
+            uint64_t frameNumber = 0;
+            Clock::time_point startTime;
+        };
+
+        Engine& m_engine;
+        uint32_t m_frameSlotCount;
+        uint32_t m_framesInFlight;
+        FramePacing m_pacing;
+        Clock::duration m_targetFramePeriod;
+        bool m_hasGraphics;
+        VkSemaphore m_computeTimeline;
+        VkSemaphore m_graphicsTimeline;
+        std::vector<VkSemaphore> m_imageAvailableSemaphores;
+        std::vector<VkSemaphore> m_renderFinishedSemaphores;
+        uint64_t m_frameNumber;
+        // The last value submitted to each timeline.
+        uint64_t m_computeValue;
+        uint64_t m_graphicsValue;
+        Clock::time_point m_nextFrameDeadline;
+        std::deque<PendingFrame> m_pendingFrames;
+        Clock::time_point m_firstFrameStartTime;
+        Clock::time_point m_lastRetireTime;
+        uint64_t m_retiredFrameCount;
+        Clock::duration m_totalLatency;
+        Clock::duration m_maxLatency;
+
+        uint64_t getRecycledFrameNumber() const;
+
+        // Frames finish when their draw does, or their compute step when nothing is drawn.
+        VkSemaphore getRetireTimeline() const;
+
+        void retireFinishedFrames();
+
+        void waitForValue(VkSemaphore timeline, uint64_t value);
+
+        void submitGraphicsBatch(VkCommandBuffer commandBuffer, bool isPresenting);
+
+        VkSemaphore createTimelineSemaphore();
+
+        VkSemaphore createBinarySemaphore();
+};
+
+}
+
+#endif // _FRAME_SCHEDULER_H
@@ -0,0 +1,280 @@
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <fmt/core.h>
+
+
+using GpuProfiler = VulkanEngine::GpuProfiler;
+using GpuProfilerScope = VulkanEngine::GpuProfilerScope;
+using GpuScopeStats = VulkanEngine::GpuScopeStats;
+
+static std::string escapeJsonString(std::string_view value) {
+    auto escaped = std::string {};
+    for (const char character : value) {
+        if (character == '"' || character == '\\') {
+            escaped += '\\';
+            escaped += character;
+        } else if (static_cast<unsigned char>(character) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(character));
+        } else {
+            escaped += character;
+        }
+    }
+
+    return escaped;
+}
+
+GpuProfiler::GpuProfiler(Engine& engine, uint32_t frameSlotCount, std::vector<GpuProfilerScope> scopes, size_t windowSize, bool keepsTrace)
+    : m_engine { engine }
+    , m_frameSlotCount { frameSlotCount }
+    , m_scopes { std::move(scopes) }
+    , m_windowSize { std::max<size_t>(windowSize, 1) }
+    , m_keepsTrace { keepsTrace }
+    , m_timestampPeriod { 1.0 }
+    , m_timestampMasks {}
+    , m_queryPool { VK_NULL_HANDLE }
+    , m_pendingFrameNumbers(static_cast<size_t>(frameSlotCount) * m_scopes.size(), 0)
+    , m_samples {}
+    , m_windowMilliseconds(m_scopes.size())
+    , m_sampleCounts(m_scopes.size(), 0)
+{
+    if (m_scopes.empty()) {
+        throw std::invalid_argument("a GPU profiler needs at least one scope!");
+    }
+
+    auto properties = VkPhysicalDeviceProperties {};
+    vkGetPhysicalDeviceProperties(m_engine.getPhysicalDevice(), &properties);
+    m_timestampPeriod = static_cast<double>(properties.limits.timestampPeriod);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_engine.getPhysicalDevice(), &queueFamilyCount, nullptr);
+    auto queueFamilies = std::vector<VkQueueFamilyProperties>(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_engine.getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+    for (const auto& scope : m_scopes) {
+        if (scope.queueFamilyIndex >= queueFamilyCount) {
+            throw std::invalid_argument(fmt::format("GPU profiler scope `{}` runs on a queue family that does not exist!", scope.name));
+        }
+
+        const uint32_t validBits = queueFamilies[scope.queueFamilyIndex].timestampValidBits;
+        if (validBits == 0) {
+            m_timestampMasks.push_back(0);
+        } else if (validBits >= 64) {
+            m_timestampMasks.push_back(UINT64_MAX);
+        } else {
+            m_timestampMasks.push_back((uint64_t { 1 } << validBits) - 1);
+        }
+    }
+
+    const auto queryPoolInfo = VkQueryPoolCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = static_cast<uint32_t>(m_pendingFrameNumbers.size() * 2),
+    };
+
+    const auto result = vkCreateQueryPool(m_engine.getLogicalDevice(), &queryPoolInfo, nullptr, &m_queryPool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    // Queries start out undefined, and have to be reset before their first use.
+    vkResetQueryPool(m_engine.getLogicalDevice(), m_queryPool, 0, queryPoolInfo.queryCount);
+}
+
+GpuProfiler::~GpuProfiler() {
+    vkDestroyQueryPool(m_engine.getLogicalDevice(), m_queryPool, nullptr);
+}
+
+bool GpuProfiler::isScopeSupported(ScopeId scope) const {
+    return m_timestampMasks.at(scope) != 0;
+}
+
+void GpuProfiler::recordBegin(VkCommandBuffer commandBuffer, uint32_t frameSlot, ScopeId scope) {
+    if (!this->isScopeSupported(scope)) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, this->getFirstQuery(frameSlot, scope));
+}
+
+void GpuProfiler::recordEnd(VkCommandBuffer commandBuffer, uint32_t frameSlot, ScopeId scope) {
+    if (!this->isScopeSupported(scope)) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, this->getFirstQuery(frameSlot, scope) + 1);
+}
+
+void GpuProfiler::markSubmitted(uint32_t frameSlot, ScopeId scope, uint64_t frameNumber) {
+    if (!this->isScopeSupported(scope)) {
+        return;
+    }
+
+    // The slot's resources were waited for before the submission, so the results of its last use are
+    // written by now. Resetting the queries on the host right after reading them makes sure they only
+    // become available again once this submission writes them, rather than whenever the device gets to
+    // a reset recorded in the command buffer.
+    this->collect(frameSlot, scope);
+    vkResetQueryPool(m_engine.getLogicalDevice(), m_queryPool, this->getFirstQuery(frameSlot, scope), 2);
+
+    m_pendingFrameNumbers[frameSlot * m_scopes.size() + scope] = frameNumber;
+}
+
+void GpuProfiler::collect() {
+    for (uint32_t frameSlot = 0; frameSlot < m_frameSlotCount; frameSlot++) {
+        for (ScopeId scope = 0; scope < m_scopes.size(); scope++) {
+            this->collect(frameSlot, scope);
+        }
+    }
+}
+
+void GpuProfiler::collect(uint32_t frameSlot, ScopeId scope) {
+    auto& pendingFrameNumber = m_pendingFrameNumbers[frameSlot * m_scopes.size() + scope];
+    if (pendingFrameNumber == 0) {
+        return;
+    }
+
+    // Each query comes back as its timestamp followed by whether it is available, so nothing blocks.
+    auto results = std::array<uint64_t, 4> {};
+    const auto result = vkGetQueryPoolResults(
+        m_engine.getLogicalDevice(),
+        m_queryPool,
+        this->getFirstQuery(frameSlot, scope),
+        2,
+        sizeof(results),
+        results.data(),
+        2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        throw std::runtime_error("failed to read timestamp query results!");
+    }
+
+    if (results[1] == 0 || results[3] == 0) {
+        return;
+    }
+
+    const auto sample = Sample {
+        .scope = scope,
+        .frameNumber = pendingFrameNumber,
+        .beginTimestamp = results[0] & m_timestampMasks[scope],
+        .endTimestamp = results[2] & m_timestampMasks[scope],
+    };
+    if (m_keepsTrace) {
+        m_samples.push_back(sample);
+    }
+
+    pendingFrameNumber = 0;
+
+    auto& window = m_windowMilliseconds[scope];
+    window.push_back(this->getMilliseconds(scope, sample.beginTimestamp, sample.endTimestamp));
+    if (window.size() > m_windowSize) {
+        window.pop_front();
+    }
+
+    m_sampleCounts[scope]++;
+}
+
+std::vector<GpuScopeStats> GpuProfiler::getStats() const {
+    auto stats = std::vector<GpuScopeStats> {};
+    for (ScopeId scope = 0; scope < m_scopes.size(); scope++) {
+        const auto& window = m_windowMilliseconds[scope];
+        auto scopeStats = GpuScopeStats {
+            .name = m_scopes[scope].name,
+            .sampleCount = m_sampleCounts[scope],
+            .windowSampleCount = window.size(),
+        };
+
+        if (!window.empty()) {
+            double totalMilliseconds = 0.0;
+            for (const double milliseconds : window) {
+                totalMilliseconds += milliseconds;
+            }
+
+            scopeStats.averageMilliseconds = totalMilliseconds / static_cast<double>(window.size());
+            scopeStats.minMilliseconds = *std::min_element(window.begin(), window.end());
+            scopeStats.maxMilliseconds = *std::max_element(window.begin(), window.end());
+        }
+
+        stats.push_back(scopeStats);
+    }
+
+    return stats;
+}
+
+void GpuProfiler::writeChromeTrace(const std::filesystem::path& filePath) const {
+    if (!m_keepsTrace) {
+        throw std::runtime_error("the GPU profiler was created without keeping a trace!");
+    }
+
+    auto file = std::ofstream { filePath, std::ios::trunc };
+    if (!file.is_open()) {
+        throw std::runtime_error(fmt::format("failed to open GPU trace file `{}` for writing!", filePath.string()));
+    }
+
+    // The trace starts at the earliest timestamp, so the times in it stay small.
+    uint64_t originTimestamp = UINT64_MAX;
+    for (const auto& sample : m_samples) {
+        originTimestamp = std::min(originTimestamp, sample.beginTimestamp);
+    }
+
+    auto isFirstEvent = true;
+    const auto writeEvent = [&file, &isFirstEvent](const std::string& event) {
+        file << (isFirstEvent ? "\n    " : ",\n    ") << event;
+        isFirstEvent = false;
+    };
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    auto namedQueueFamilies = std::vector<uint32_t> {};
+    for (const auto& scope : m_scopes) {
+        if (std::find(namedQueueFamilies.begin(), namedQueueFamilies.end(), scope.queueFamilyIndex) != namedQueueFamilies.end()) {
+            continue;
+        }
+
+        namedQueueFamilies.push_back(scope.queueFamilyIndex);
+        writeEvent(fmt::format(
+            "{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {0}, \"args\": {{\"name\": \"Queue family {0}\"}}}}",
+            scope.queueFamilyIndex
+        ));
+    }
+
+    for (const auto& sample : m_samples) {
+        const auto& scope = m_scopes[sample.scope];
+        const double startMicroseconds = this->getMilliseconds(sample.scope, originTimestamp, sample.beginTimestamp) * 1000.0;
+        const double durationMicroseconds = this->getMilliseconds(sample.scope, sample.beginTimestamp, sample.endTimestamp) * 1000.0;
+        writeEvent(fmt::format(
+            "{{\"name\": \"{}\", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{\"frame\": {}}}}}",
+            escapeJsonString(scope.name),
+            scope.queueFamilyIndex,
+            startMicroseconds,
+            durationMicroseconds,
+            sample.frameNumber
+        ));
+    }
+
+    file << "\n]}\n";
+
+    file.close();
+    if (!file) {
+        throw std::runtime_error(fmt::format("failed to write GPU trace file `{}`!", filePath.string()));
+    }
+}
+
+uint32_t GpuProfiler::getFirstQuery(uint32_t frameSlot, ScopeId scope) const {
+    return static_cast<uint32_t>((frameSlot * m_scopes.size() + scope) * 2);
+}
+
+double GpuProfiler::getMilliseconds(ScopeId scope, uint64_t beginTimestamp, uint64_t endTimestamp) const {
+    // A timestamp with fewer than 64 valid bits wraps around, which the mask undoes for short spans.
+    const uint64_t ticks = (endTimestamp - beginTimestamp) & m_timestampMasks[scope];
+
+    return static_cast<double>(ticks) * m_timestampPeriod / 1.0e6;
+}
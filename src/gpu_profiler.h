@@ -0,0 +1,106 @@
+#ifndef _GPU_PROFILER_H
+#define _GPU_PROFILER_H
+
+#include <vulkan/vulkan.h>
+
+#include "engine.h"
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// A span of GPU work timed by the profiler, such as a pass. The scope is timed on the queues of
+// family `queueFamilyIndex`, which decides whether the device can time it at all.
+struct GpuProfilerScope final {
+    std::string name;
+    uint32_t queueFamilyIndex = 0;
+};
+
+struct GpuScopeStats final {
+    std::string name;
+    uint64_t sampleCount = 0;
+    // Over the most recent samples only, so the stats follow changes to the workload.
+    uint64_t windowSampleCount = 0;
+    double averageMilliseconds = 0.0;
+    double minMilliseconds = 0.0;
+    double maxMilliseconds = 0.0;
+};
+
+// Times scopes of GPU work with timestamp queries. Each scope has a pair of queries in every frame
+// slot, which the command buffers of the slot write, so command buffers can be recorded once and
+// submitted over and over. The host resets the queries as it marks a submission, so they only become
+// available once that submission has written them. The results are read back without waiting a few
+// frames later, or at the latest right before the next submission of the slot.
+//
+// The most recent `windowSize` results of each scope make up its stats. Every result is only kept when
+// `keepsTrace` asks for a trace, since a long session would otherwise grow without bound.
+class GpuProfiler final {
+    public:
+        using ScopeId = uint32_t;
+
+        explicit GpuProfiler(Engine& engine, uint32_t frameSlotCount, std::vector<GpuProfilerScope> scopes, size_t windowSize, bool keepsTrace);
+
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        // Whether the queues the scope runs on write timestamps. Scopes the device cannot time record nothing.
+        bool isScopeSupported(ScopeId scope) const;
+
+        // Records the start of the scope into a command buffer of the frame slot, outside of any render pass.
+        void recordBegin(VkCommandBuffer commandBuffer, uint32_t frameSlot, ScopeId scope);
+
+        void recordEnd(VkCommandBuffer commandBuffer, uint32_t frameSlot, ScopeId scope);
+
+        // Call right before submitting a command buffer that records the scope for the frame slot, once the
+        // slot's last submission has finished.
+        void markSubmitted(uint32_t frameSlot, ScopeId scope, uint64_t frameNumber);
+
+        // Reads back the results the device has written by now, without blocking.
+        void collect();
+
+        std::vector<GpuScopeStats> getStats() const;
+
+        // Writes every result collected so far in the Chrome trace event format, with one track per queue family.
+        // Only available when the profiler keeps a trace.
+        void writeChromeTrace(const std::filesystem::path& filePath) const;
+    private:
+        struct Sample final {
+            ScopeId scope = 0;
+            uint64_t frameNumber = 0;
+            uint64_t beginTimestamp = 0;
+            uint64_t endTimestamp = 0;
+        };
+
+        Engine& m_engine;
+        uint32_t m_frameSlotCount;
+        std::vector<GpuProfilerScope> m_scopes;
+        size_t m_windowSize;
+        bool m_keepsTrace;
+        double m_timestampPeriod;
+        // The bits of a timestamp that are valid on each scope's queues, or zero when they write none.
+        std::vector<uint64_t> m_timestampMasks;
+        VkQueryPool m_queryPool;
+        // The frame submitted with each scope in each slot and not read back yet, or zero.
+        std::vector<uint64_t> m_pendingFrameNumbers;
+        std::vector<Sample> m_samples;
+        std::vector<std::deque<double>> m_windowMilliseconds;
+        std::vector<uint64_t> m_sampleCounts;
+
+        uint32_t getFirstQuery(uint32_t frameSlot, ScopeId scope) const;
+
+        // Reads back the results of the scope in the slot if the device has written them.
+        void collect(uint32_t frameSlot, ScopeId scope);
+
+        double getMilliseconds(ScopeId scope, uint64_t beginTimestamp, uint64_t endTimestamp) const;
+};
+
+}
+
+#endif // _GPU_PROFILER_H
@@ -1,6 +1,19 @@
 #include <vulkan/vulkan.h>
 
 #include "engine.h"
+#include "particle.h"
+#include "particle_integrator.h"
+#include "cpu_particle_simulation.h"
+#include "particle_generator.h"
+#include "upload_manager.h"
+#include "frame_scheduler.h"
+#include "gpu_profiler.h"
+#include "command_buffer_cache.h"
+#include "pipeline_builder.h"
+#include "mapped_file.h"
+#include "shader_archive.h"
+#include "shader_hot_reloader.h"
+#include "workgroup_size_tuner.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -11,10 +24,19 @@
 #include <cstdint>
 #include <limits>
 #include <algorithm>
+#include <array>
 #include <fstream>
+#include <filesystem>
 #include <chrono>
 #include <random>
 #include <unordered_set>
+#include <string_view>
+#include <charconv>
+#include <tuple>
+#include <cmath>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 
 #include <fmt/core.h>
 #include <fmt/ostream.h>
@@ -36,116 +58,419 @@
 #include <tiny_obj_loader/tiny_obj_loader.h>
 
 #include <compile_glsl_shaders/shaders_glsl.h>
-#include <compile_hlsl_shaders/shaders_hlsl.h>
 
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
-const uint32_t PARTICLE_COUNT = 8192;
+const uint32_t DEFAULT_PARTICLE_COUNT = 8192;
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// The compute workgroup size when it is neither tuned for the device nor set with `--workgroup-size`.
+const uint32_t DEFAULT_COMPUTE_WORKGROUP_SIZE = 256;
+
+// This must match the `local_size_x_id` declared in the compute shaders.
+const uint32_t COMPUTE_WORKGROUP_SIZE_CONSTANT_ID = 0;
+
+// The number of back-to-back steps timed for each candidate workgroup size when tuning it.
+const uint32_t WORKGROUP_SIZE_BENCHMARK_STEP_COUNT = 16;
+
+// The number of times the steps are timed for each candidate after warming up, of which the fastest counts.
+const uint32_t WORKGROUP_SIZE_BENCHMARK_RUN_COUNT = 5;
+
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+// The simulation ping-pongs between the particle buffers of consecutive frame slots, so there are always
+// at least two slots, even with a single frame in flight.
+const uint32_t MIN_FRAME_SLOT_COUNT = 2;
+
+const double DEFAULT_TARGET_FRAME_RATE = 60.0;
+
+const uint32_t DEFAULT_MAX_SUBSTEP_COUNT = 16;
+
+// Absorbs the rounding of frame times that are a whole number of fixed time steps long.
+const double SUBSTEP_EPSILON = 1.0e-6;
+
+// The pipeline cache is kept in the temporary directory unless `--pipeline-cache` says otherwise, so that
+// every instance of the app on the machine shares it.
+const std::string_view DEFAULT_PIPELINE_CACHE_FILE_NAME = "LearnVulkanDemos_09_ComputeShaders.pipeline_cache";
+
+// The workgroup sizes tuned for each device live next to the pipeline cache, for the same reason.
+const std::string_view WORKGROUP_SIZE_FILE_NAME = "LearnVulkanDemos_09_ComputeShaders.workgroup_sizes";
+
+// The simulation step length used when there is no display to pace the frames against.
+const float HEADLESS_FRAME_TIME = 1000.0f / 60.0f;
+
+// The passes the GPU profiler times, by their index in its list of scopes.
+const uint32_t COMPUTE_PROFILER_SCOPE = 0;
+const uint32_t RENDER_PASS_PROFILER_SCOPE = 1;
+
+// The number of most recent frames the GPU time of each pass is averaged over.
+const size_t GPU_PROFILER_WINDOW_SIZE = 240;
+
+// The largest difference allowed between the GPU and the CPU reference when verifying a compute step.
+// The GPU may fuse the multiply and add of the position update, so the results are not bit-identical.
+const float VERIFY_TOLERANCE = 1.0e-5f;
+
+const uint64_t VERTEX_SHADER_KEY = shaders_glsl::shaderKey("shader_compute.vert.glsl");
+const uint64_t FRAGMENT_SHADER_KEY = shaders_glsl::shaderKey("shader_compute.frag.glsl");
 
 
 using Engine = VulkanEngine::Engine;
+using MemoryAllocation = VulkanEngine::MemoryAllocation;
+using UploadManager = VulkanEngine::UploadManager;
+using FrameScheduler = VulkanEngine::FrameScheduler;
+using CommandBufferCache = VulkanEngine::CommandBufferCache;
+using FramePacing = VulkanEngine::FramePacing;
+using GpuProfiler = VulkanEngine::GpuProfiler;
+using GpuProfilerScope = VulkanEngine::GpuProfilerScope;
+using MappedFile = VulkanEngine::MappedFile;
+using PipelineCacheLoadStatus = VulkanEngine::PipelineCacheLoadStatus;
+using PipelineBuilder = VulkanEngine::PipelineBuilder;
+using ShaderArchive = VulkanEngine::ShaderArchive;
+using ShaderCodeLifetime = VulkanEngine::ShaderCodeLifetime;
+using ShaderHotReloader = VulkanEngine::ShaderHotReloader;
+using ShaderReflection = VulkanEngine::ShaderReflection;
+using WorkgroupSizeTuner = VulkanEngine::WorkgroupSizeTuner;
+
+
+enum class ParticleLayout {
+    ArrayOfStructures,
+    StructureOfArrays
+};
 
+enum class SimulationBackend {
+    Gpu,
+    Cpu
+};
 
-struct ComputeShaderUniformBufferObject {
-    float deltaTime = 1.0f;
+enum class ParticleInit {
+    Gpu,
+    Cpu
+};
+
+enum class WorkgroupSizeOrigin {
+    Default,
+    CommandLine,
+    Tuned,
+    Stored
 };
 
-struct Particle {
-    glm::vec2 position;
-    glm::vec2 velocity;
-    glm::vec4 color;
+struct AppSettings final {
+    bool headless = false;
+    uint32_t headlessStepCount = 1000;
+    uint32_t particleCount = DEFAULT_PARTICLE_COUNT;
+    ParticleLayout particleLayout = ParticleLayout::ArrayOfStructures;
+    bool verify = false;
+    SimulationBackend simulationBackend = SimulationBackend::Gpu;
+    uint32_t threadCount = static_cast<uint32_t>(ThreadPool::getDefaultThreadCount());
+    std::optional<uint64_t> seed;
+    ParticleInit particleInit = ParticleInit::Gpu;
+    std::optional<std::string> particlesFile;
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    FramePacing framePacing = FramePacing::Throughput;
+    uint32_t targetFrameRate = static_cast<uint32_t>(DEFAULT_TARGET_FRAME_RATE);
+    // The number of fixed time steps simulated per second, or zero for one step per frame as long as the frame.
+    uint32_t simulationRate = 0;
+    uint32_t maxSubstepCount = DEFAULT_MAX_SUBSTEP_COUNT;
+    bool usePipelineCache = true;
+    std::optional<std::string> pipelineCacheFile;
+    bool parallelPipelineBuild = true;
+    // The directory of shader sources to recompile and reload while the app runs, if any.
+    std::optional<std::string> watchShaderDirectory;
+    // An archive of SPIR-V shaders that replace the embedded shaders of the same name, if any.
+    std::optional<std::string> shaderArchiveFile;
+    // The compute workgroup size, or none to use the size tuned for the device.
+    std::optional<uint32_t> computeWorkgroupSize;
+    bool profileGpu = false;
+    // The file to write the Chrome trace of the GPU passes to at exit, if any.
+    std::optional<std::string> gpuTraceFile;
+
+    static AppSettings fromCommandLine(int argc, const char* const* argv) {
+        auto settings = AppSettings {};
+        auto requestedParticleInit = std::optional<ParticleInit> {};
+        for (int i = 1; i < argc; i++) {
+            const auto argument = std::string_view { argv[i] };
+            const auto nextValue = [&]() -> std::string_view {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument { fmt::format("missing value for command line argument `{}`", argument) };
+                }
+
+                i++;
+
+                return std::string_view { argv[i] };
+            };
+
+            if (argument == "--headless") {
+                settings.headless = true;
+            } else if (argument == "--steps") {
+                settings.headlessStepCount = AppSettings::parseUint32(argument, nextValue());
+            } else if (argument == "--particles") {
+                settings.particleCount = AppSettings::parseUint32(argument, nextValue());
+                if (settings.particleCount == 0) {
+                    throw std::invalid_argument { "expected at least one particle for `--particles`" };
+                }
+            } else if (argument == "--layout") {
+                settings.particleLayout = AppSettings::parseParticleLayout(argument, nextValue());
+            } else if (argument == "--verify") {
+                settings.verify = true;
+            } else if (argument == "--backend") {
+                settings.simulationBackend = AppSettings::parseSimulationBackend(argument, nextValue());
+            } else if (argument == "--init") {
+                requestedParticleInit = AppSettings::parseParticleInit(argument, nextValue());
+            } else if (argument == "--particles-file") {
+                settings.particlesFile = std::string { nextValue() };
+            } else if (argument == "--seed") {
+                settings.seed = AppSettings::parseUint64(argument, nextValue());
+            } else if (argument == "--threads") {
+                settings.threadCount = AppSettings::parseUint32(argument, nextValue());
+                if (settings.threadCount == 0) {
+                    throw std::invalid_argument { "expected at least one thread for `--threads`" };
+                }
+            } else if (argument == "--frames-in-flight") {
+                settings.framesInFlight = AppSettings::parseUint32(argument, nextValue());
+                if (settings.framesInFlight == 0 || settings.framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+                    throw std::invalid_argument { fmt::format("expected between 1 and {} frames for `--frames-in-flight`", MAX_FRAMES_IN_FLIGHT) };
+                }
+            } else if (argument == "--sim-rate") {
+                settings.simulationRate = AppSettings::parseUint32(argument, nextValue());
+            } else if (argument == "--max-substeps") {
+                settings.maxSubstepCount = AppSettings::parseUint32(argument, nextValue());
+                if (settings.maxSubstepCount == 0) {
+                    throw std::invalid_argument { "expected at least one substep for `--max-substeps`" };
+                }
+            } else if (argument == "--pipeline-cache") {
+                settings.pipelineCacheFile = std::string { nextValue() };
+            } else if (argument == "--no-pipeline-cache") {
+                settings.usePipelineCache = false;
+            } else if (argument == "--serial-pipelines") {
+                settings.parallelPipelineBuild = false;
+            } else if (argument == "--watch-shaders") {
+                settings.watchShaderDirectory = std::string { nextValue() };
+            } else if (argument == "--shader-archive") {
+                settings.shaderArchiveFile = std::string { nextValue() };
+            } else if (argument == "--profile-gpu") {
+                settings.profileGpu = true;
+            } else if (argument == "--gpu-trace") {
+                settings.profileGpu = true;
+                settings.gpuTraceFile = std::string { nextValue() };
+            } else if (argument == "--workgroup-size") {
+                settings.computeWorkgroupSize = AppSettings::parseWorkgroupSize(argument, nextValue());
+            } else if (argument == "--pacing") {
+                settings.framePacing = AppSettings::parseFramePacing(argument, nextValue());
+            } else if (argument == "--target-fps") {
+                settings.targetFrameRate = AppSettings::parseUint32(argument, nextValue());
+                if (settings.targetFrameRate == 0) {
+                    throw std::invalid_argument { "expected at least one frame per second for `--target-fps`" };
+                }
+            } else {
+                throw std::invalid_argument { fmt::format("unknown command line argument `{}`", argument) };
+            }
+        }
+
+        if (settings.pipelineCacheFile.has_value() && !settings.usePipelineCache) {
+            throw std::invalid_argument { "`--pipeline-cache` and `--no-pipeline-cache` are mutually exclusive" };
+        }
+
+        if (settings.verify && !settings.headless) {
+            throw std::invalid_argument { "`--verify` requires `--headless`" };
+        }
+
+        if (settings.verify && settings.particleLayout != ParticleLayout::ArrayOfStructures) {
+            throw std::invalid_argument { "`--verify` requires `--layout aos`" };
+        }
+
+        if (settings.verify && settings.simulationBackend != SimulationBackend::Gpu) {
+            throw std::invalid_argument { "`--verify` requires `--backend gpu`" };
+        }
+
+        if (settings.simulationBackend == SimulationBackend::Cpu && settings.particleLayout != ParticleLayout::ArrayOfStructures) {
+            throw std::invalid_argument { "`--backend cpu` requires `--layout aos`" };
+        }
+
+        if (settings.particlesFile.has_value() && settings.particleLayout != ParticleLayout::ArrayOfStructures) {
+            throw std::invalid_argument { "`--particles-file` requires `--layout aos`" };
+        }
+
+        // The init shader writes straight into the storage buffers, so it only applies when the particles are 
+        // simulated on the GPU in the array of structures layout, and are generated rather than loaded.
+        const bool canInitializeOnGpu = (settings.simulationBackend == SimulationBackend::Gpu)
+            && (settings.particleLayout == ParticleLayout::ArrayOfStructures)
+            && !settings.particlesFile.has_value();
+        if (requestedParticleInit == ParticleInit::Gpu && !canInitializeOnGpu) {
+            throw std::invalid_argument { "`--init gpu` requires `--backend gpu`, `--layout aos`, and no `--particles-file`" };
+        }
+
+        settings.particleInit = requestedParticleInit.value_or(canInitializeOnGpu ? ParticleInit::Gpu : ParticleInit::Cpu);
+
+        return settings;
+    }
 
-    static VkVertexInputBindingDescription getBindingDescription() {
-        const auto bindingDescription = VkVertexInputBindingDescription {
-            .binding = 0,
-            .stride = sizeof(Particle),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-        };
+    static uint32_t parseUint32(std::string_view argument, std::string_view value) {
+        uint32_t result = 0;
+        const auto [end, errorCode] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (errorCode != std::errc {} || end != value.data() + value.size()) {
+            throw std::invalid_argument { fmt::format("expected an unsigned integer for `{}`, got `{}`", argument, value) };
+        }
 
-        return bindingDescription;
+        return result;
     }
 
-    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
-        const auto attributeDescriptions = std::array<VkVertexInputAttributeDescription, 2> {
-            VkVertexInputAttributeDescription {
-                .binding = 0,
-                .location = 0,
-                .format = VK_FORMAT_R32G32_SFLOAT,
-                .offset = offsetof(Particle, position),
-            },
-            VkVertexInputAttributeDescription {
-                .binding = 0,
-                .location = 1,
-                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-                .offset = offsetof(Particle, color),
-            }
-        };
-
-        return attributeDescriptions;
+    static uint64_t parseUint64(std::string_view argument, std::string_view value) {
+        uint64_t result = 0;
+        const auto [end, errorCode] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (errorCode != std::errc {} || end != value.data() + value.size()) {
+            throw std::invalid_argument { fmt::format("expected an unsigned integer for `{}`, got `{}`", argument, value) };
+        }
+
+        return result;
     }
-};
 
-class ParticleGeneratorState final {
-    public:
-        explicit ParticleGeneratorState() {
-            m_rndEngine = std::default_random_engine { (unsigned) time(nullptr) };
-            m_rndDist = std::uniform_real_distribution<float> { 0.0f, 1.0f };
+    static std::optional<uint32_t> parseWorkgroupSize(std::string_view argument, std::string_view value) {
+        if (value == "auto") {
+            return std::nullopt;
         }
 
-        inline float next() {
-            return m_rndDist(m_rndEngine);
+        const uint32_t workgroupSize = AppSettings::parseUint32(argument, value);
+        if (workgroupSize == 0) {
+            throw std::invalid_argument { fmt::format("expected `auto` or a positive workgroup size for `{}`", argument) };
         }
-    private:
-        std::default_random_engine m_rndEngine;
-        std::uniform_real_distribution<float> m_rndDist;
+
+        return workgroupSize;
+    }
+
+    static ParticleLayout parseParticleLayout(std::string_view argument, std::string_view value) {
+        if (value == "aos") {
+            return ParticleLayout::ArrayOfStructures;
+        } else if (value == "soa") {
+            return ParticleLayout::StructureOfArrays;
+        }
+
+        throw std::invalid_argument { fmt::format("expected one of `aos` or `soa` for `{}`, got `{}`", argument, value) };
+    }
+
+    static ParticleInit parseParticleInit(std::string_view argument, std::string_view value) {
+        if (value == "gpu") {
+            return ParticleInit::Gpu;
+        } else if (value == "cpu") {
+            return ParticleInit::Cpu;
+        }
+
+        throw std::invalid_argument { fmt::format("expected one of `gpu` or `cpu` for `{}`, got `{}`", argument, value) };
+    }
+
+    static FramePacing parseFramePacing(std::string_view argument, std::string_view value) {
+        if (value == "low-latency") {
+            return FramePacing::LowLatency;
+        } else if (value == "throughput") {
+            return FramePacing::Throughput;
+        } else if (value == "fixed-rate") {
+            return FramePacing::FixedRate;
+        }
+
+        throw std::invalid_argument { fmt::format("expected one of `low-latency`, `throughput`, or `fixed-rate` for `{}`, got `{}`", argument, value) };
+    }
+
+    static SimulationBackend parseSimulationBackend(std::string_view argument, std::string_view value) {
+        if (value == "gpu") {
+            return SimulationBackend::Gpu;
+        } else if (value == "cpu") {
+            return SimulationBackend::Cpu;
+        }
+
+        throw std::invalid_argument { fmt::format("expected one of `gpu` or `cpu` for `{}`, got `{}`", argument, value) };
+    }
+};
+
+
+struct ComputeShaderUniformBufferObject {
+    float deltaTime = 1.0f;
+    uint32_t particleCount = 0;
+    uint32_t groupCountX = 0;
 };
 
-class ParticleGenerator final {
+// This must match the push constant block declared in the init compute shaders.
+struct InitShaderPushConstants {
+    uint32_t seedLow = 0;
+    uint32_t seedHigh = 0;
+    uint32_t particleCount = 0;
+    uint32_t groupCountX = 0;
+    float aspectRatio = 1.0f;
+};
+
+// The extra compute descriptor sets of a frame slot for running several substeps in one frame. They bind 
+// the same uniform buffer as the frame's main set, and ping-pong between the frame's buffer and the 
+// scratch buffer.
+struct SubstepDescriptorSets {
+    VkDescriptorSet previousToScratch = VK_NULL_HANDLE;
+    VkDescriptorSet currentToScratch = VK_NULL_HANDLE;
+    VkDescriptorSet scratchToCurrent = VK_NULL_HANDLE;
+};
+
+// A pipeline rebuilt from reloaded shaders, which replaces the current one at the next frame boundary.
+struct ReloadedPipeline {
+    VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
+// A replaced pipeline, which is destroyed once the last frame that may have bound it has finished.
+struct RetiredPipeline {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    uint64_t lastFrameNumber = 0;
+};
+
+// A reference to a cached shader module, given back when it goes out of scope, so that a pipeline that
+// fails to build does not keep its modules from ever being evicted.
+class ShaderModuleReference final {
     public:
-        explicit ParticleGenerator(ParticleGeneratorState initialState)
-            : m_state { initialState }
+        explicit ShaderModuleReference(Engine& engine, VkShaderModule shaderModule)
+            : m_engine { engine }
+            , m_shaderModule { shaderModule }
         {
         }
 
-        size_t generate(std::vector<Particle>& particles) {
-            for (auto& particle : particles) {
-                const float r = 0.25f * glm::sqrt(m_state.next());
-                const float theta = m_state.next() * 2.0f * glm::pi<float>();
-                const float x = r * glm::cos(theta) * HEIGHT / WIDTH;
-                const float y = r * glm::sin(theta);
+        ~ShaderModuleReference() {
+            m_engine.releaseShaderModule(m_shaderModule);
+        }
 
-                particle.position = glm::vec2(x, y);
-                particle.velocity = glm::normalize(glm::vec2(x,y)) * 0.00025f;
-                particle.color = glm::vec4(m_state.next(), m_state.next(), m_state.next(), 1.0f);
-            }
+        ShaderModuleReference(const ShaderModuleReference&) = delete;
+        ShaderModuleReference& operator=(const ShaderModuleReference&) = delete;
 
-            return particles.size();
+        VkShaderModule get() const {
+            return m_shaderModule;
         }
     private:
-        ParticleGeneratorState m_state;
+        Engine& m_engine;
+        VkShaderModule m_shaderModule;
 };
 
 class App final {
     public:
-        explicit App() = default;
+        explicit App(AppSettings settings)
+            : m_settings { settings }
+        {
+        }
 
         ~App() {
             this->cleanup();
         }
 
         void run() {
+            m_startTime = std::chrono::steady_clock::now();
             this->initApp();
             this->mainLoop();
         }
     private:
+        AppSettings m_settings;
+
+        // Declared before the engine, so the mapping outlives the shader caches that point into it.
+        std::unique_ptr<ShaderArchive> m_shaderArchive;
+        // The code of the embedded shaders the archive replaces, pointing into the archive's mapping.
+        std::unordered_map<uint64_t, std::span<const uint32_t>> m_archivedShaders;
+
         std::unique_ptr<Engine> m_engine;
+        std::unique_ptr<UploadManager> m_uploadManager;
 
-        std::unordered_map<std::string, std::vector<uint8_t>> m_glslShaders;
-        std::unordered_map<std::string, std::vector<uint8_t>> m_hlslShaders;
 
         VkSwapchainKHR m_swapChain;
         std::vector<VkImage> m_swapChainImages;
@@ -154,10 +479,6 @@ class App final {
         std::vector<VkImageView> m_swapChainImageViews;
         std::vector<VkFramebuffer> m_swapChainFramebuffers;
 
-        std::vector<VkSemaphore> m_imageAvailableSemaphores;
-        std::vector<VkSemaphore> m_renderFinishedSemaphores;
-        std::vector<VkFence> m_inFlightFences;
-
         VkRenderPass m_renderPass;
 
     
@@ -169,61 +490,322 @@ class App final {
         VkPipeline m_computePipeline;
 
         std::vector<VkBuffer> m_shaderStorageBuffers;
-        std::vector<VkDeviceMemory> m_shaderStorageBuffersMemory;
+        std::vector<MemoryAllocation> m_shaderStorageBuffersMemory;
+        std::vector<void*> m_shaderStorageBuffersMapped;
+
+        std::vector<VkBuffer> m_positionStorageBuffers;
+        std::vector<MemoryAllocation> m_positionStorageBuffersMemory;
+        std::vector<VkBuffer> m_velocityStorageBuffers;
+        std::vector<MemoryAllocation> m_velocityStorageBuffersMemory;
+        VkBuffer m_colorBuffer = VK_NULL_HANDLE;
+        MemoryAllocation m_colorBufferMemory;
 
         std::vector<VkBuffer> m_uniformBuffers;
-        std::vector<VkDeviceMemory> m_uniformBuffersMemory;
+        std::vector<MemoryAllocation> m_uniformBuffersMemory;
         std::vector<void*> m_uniformBuffersMapped;
 
         VkDescriptorPool m_descriptorPool;
         std::vector<VkDescriptorSet> m_computeDescriptorSets;
+        std::vector<SubstepDescriptorSets> m_substepDescriptorSets;
 
-        std::vector<VkCommandBuffer> m_commandBuffers;
-        std::vector<VkCommandBuffer> m_computeCommandBuffers;
+        std::unique_ptr<CommandBufferCache> m_commandBuffers;
+        std::unique_ptr<CommandBufferCache> m_computeCommandBuffers;
 
-        std::vector<VkSemaphore> m_computeFinishedSemaphores;
-        std::vector<VkFence> m_computeInFlightFences;
+        std::unique_ptr<FrameScheduler> m_frameScheduler;
         uint32_t m_currentFrame = 0;
 
+        std::unique_ptr<GpuProfiler> m_gpuProfiler;
+
+        uint32_t m_computeGroupCountX = 0;
+        uint32_t m_computeGroupCountY = 0;
+        uint32_t m_computeWorkgroupSize = DEFAULT_COMPUTE_WORKGROUP_SIZE;
+        WorkgroupSizeOrigin m_computeWorkgroupSizeOrigin = WorkgroupSizeOrigin::Default;
+        // Only kept until the workgroup size is tuned, when there is no size stored for the device yet.
+        std::unique_ptr<WorkgroupSizeTuner> m_workgroupSizeTuner;
+        std::chrono::steady_clock::duration m_workgroupSizeTuningTime {};
+
         float m_lastFrameTime = 0.0f;
+        double m_simulationTimeAccumulator = 0.0;
+        uint32_t m_substepCount = 1;
+        uint64_t m_totalSubstepCount = 0;
         double m_lastTime = 0.0f;
 
+        ParticleIntegrator m_particleIntegrator;
+        std::unique_ptr<CpuParticleSimulation> m_cpuSimulation;
+        uint64_t m_particleSeed = 0;
+
         bool m_enableValidationLayers { false };
         bool m_enableDebuggingExtensions { false };
 
+        std::chrono::steady_clock::time_point m_startTime;
+        size_t m_builtPipelineCount = 0;
+        std::chrono::steady_clock::duration m_pipelineBuildTime {};
+        bool m_hasReportedFirstFrame = false;
+
+        std::unique_ptr<ShaderHotReloader> m_shaderHotReloader;
+        // The code of the last reload of each shader that made it into a pipeline. Only the reloader's thread
+        // touches it.
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_reloadedShaderCode;
+        std::mutex m_reloadedPipelinesMutex;
+        std::vector<ReloadedPipeline> m_reloadedPipelines;
+        std::vector<RetiredPipeline> m_retiredPipelines;
+
 
         void initApp() {
+            this->createInitialParticleSource();
+
+            if (m_settings.headless && m_settings.simulationBackend == SimulationBackend::Cpu) {
+                // Nothing is drawn or dispatched, so a headless CPU simulation never needs a Vulkan device.
+                this->createCpuSimulation(this->generateParticles());
+
+                return;
+            }
+
+            this->openShaderArchive();
             this->createEngine();
+            this->loadPipelineCache();
+            this->selectComputeWorkgroupSize();
+            this->createUploadManager();
         
-            this->createShaderBinaries();
-
-            this->createSwapChain();
-            this->createSwapChainImageViews();
-            this->createRenderPass();
-            this->createColorResources();
-            this->createDepthResources();
-            this->createSwapChainFramebuffers();
-            this->createGraphicsSyncObjects();
+            if (!m_engine->isHeadless()) {
+                this->createSwapChain();
+                this->createSwapChainImageViews();
+                this->createRenderPass();
+                this->createColorResources();
+                this->createDepthResources();
+                this->createSwapChainFramebuffers();
+            }
 
 
             this->createDescriptorPool();
             this->createComputeDescriptorSetLayout();
-            this->createGraphicsPipeline();
-            this->createComputePipeline();
+
+            // The pipelines only depend on the render pass and the descriptor set layouts, so they compile on
+            // worker threads while the particles are generated and the buffers are filled.
+            auto pipelineBuilder = PipelineBuilder { m_settings.parallelPipelineBuild };
+            if (!m_engine->isHeadless()) {
+                pipelineBuilder.add([this]() { this->createGraphicsPipeline(); });
+            }
+            pipelineBuilder.add([this]() { this->createComputePipeline(); });
 
 
+            this->createComputeDispatchSize();
             this->createShaderStorageBuffers();
             this->createUniformBuffers();
+            this->submitInitialUploads();
 
         
             this->createComputeDescriptorSets();
-            this->createCommandBuffers();
+
+            pipelineBuilder.wait();
+            m_builtPipelineCount = pipelineBuilder.getPipelineCount();
+            m_pipelineBuildTime = pipelineBuilder.getBuildTime();
+
+            if (m_workgroupSizeTuner) {
+                this->tuneComputeWorkgroupSize();
+            }
+
+            if (!m_engine->isHeadless()) {
+                this->createCommandBuffers();
+            }
             this->createComputeCommandBuffers();
-            this->createComputeSyncObjects();
+            this->createFrameScheduler();
+            this->createGpuProfiler();
+            this->savePipelineCache();
+
+            this->printQueueFamilies();
+            this->printMemoryStats();
+            this->printPipelineCacheStatus();
+            this->printShaderModuleCacheStats();
+            this->printComputeWorkgroupSize();
+
+            this->createShaderHotReloader();
+        }
+
+        void submitInitialUploads() {
+            const auto uploadTicket = m_uploadManager->flush();
+
+            // On a shared queue the first simulation step and draw are ordered after the uploads, and the barrier at
+            // the end of the upload batch makes them visible to both. Dedicated compute and transfer queues are not
+            // ordered against each other, so wait for the uploads once before the first step.
+            const auto& indices = m_engine->getQueueFamilyIndices();
+            if (indices.hasDedicatedComputeFamily() || indices.hasDedicatedTransferFamily()) {
+                m_uploadManager->wait(uploadTicket);
+            }
+        }
+
+        void printQueueFamilies() const {
+            const auto& indices = m_engine->getQueueFamilyIndices();
+            if (indices.hasDedicatedComputeFamily()) {
+                fmt::println(
+                    "Running compute on dedicated queue family {} alongside graphics queue family {}",
+                    indices.getComputeFamily(),
+                    indices.graphicsAndComputeFamily.value()
+                );
+            } else {
+                fmt::println("Running compute on graphics queue family {}", indices.graphicsAndComputeFamily.value());
+            }
+
+            if (indices.hasDedicatedTransferFamily()) {
+                fmt::println("Running uploads and readbacks on dedicated transfer queue family {}", indices.getTransferFamily());
+            }
+        }
+
+        void printTimeToFirstFrame() const {
+            const auto timeToFirstFrame = std::chrono::duration<double, std::milli> { std::chrono::steady_clock::now() - m_startTime };
+            if (m_builtPipelineCount == 0) {
+                fmt::println("Time to first frame: {:.3f} ms", timeToFirstFrame.count());
+
+                return;
+            }
+
+            const auto pipelineBuildTime = std::chrono::duration<double, std::milli> { m_pipelineBuildTime };
+            fmt::println(
+                "Time to first frame: {:.3f} ms, with {} pipelines built {} in {:.3f} ms",
+                timeToFirstFrame.count(),
+                m_builtPipelineCount,
+                m_settings.parallelPipelineBuild ? "in parallel" : "serially",
+                pipelineBuildTime.count()
+            );
+        }
+
+        void printShaderModuleCacheStats() const {
+            const auto stats = m_engine->getShaderModuleCacheStats();
+            fmt::println(
+                "Shader modules: {} cached, {} requests served from the cache and {} compiled",
+                stats.moduleCount,
+                stats.hitCount,
+                stats.missCount
+            );
+        }
+
+        void printComputeWorkgroupSize() const {
+            switch (m_computeWorkgroupSizeOrigin) {
+                case WorkgroupSizeOrigin::Default:
+                    fmt::println("Compute workgroup size: {}", m_computeWorkgroupSize);
+                    break;
+                case WorkgroupSizeOrigin::CommandLine:
+                    fmt::println("Compute workgroup size: {}, set with `--workgroup-size`", m_computeWorkgroupSize);
+                    break;
+                case WorkgroupSizeOrigin::Tuned:
+                    fmt::println(
+                        "Compute workgroup size: {}, tuned for this device in {:.3f} ms",
+                        m_computeWorkgroupSize,
+                        std::chrono::duration<double, std::milli> { m_workgroupSizeTuningTime }.count()
+                    );
+                    break;
+                case WorkgroupSizeOrigin::Stored:
+                    fmt::println("Compute workgroup size: {}, tuned for this device by an earlier run", m_computeWorkgroupSize);
+                    break;
+            }
+        }
+
+        void printPipelineCacheStatus() {
+            const auto& pipelineCache = m_engine->getPipelineCache();
+            switch (pipelineCache.getLoadStatus()) {
+                case PipelineCacheLoadStatus::InMemory:
+                    fmt::println("Pipeline cache: disabled");
+                    break;
+                case PipelineCacheLoadStatus::Missing:
+                    fmt::println("Pipeline cache: starting a new cache in `{}`", pipelineCache.getFilePath().string());
+                    break;
+                case PipelineCacheLoadStatus::Rejected:
+                    fmt::println("Pipeline cache: ignored incompatible `{}`", pipelineCache.getFilePath().string());
+                    break;
+                case PipelineCacheLoadStatus::Loaded:
+                    fmt::println("Pipeline cache: loaded {} bytes from `{}`", pipelineCache.getLoadedSize(), pipelineCache.getFilePath().string());
+                    break;
+            }
+        }
+
+        void printMemoryStats() const {
+            const auto stats = m_engine->getMemoryStats();
+            fmt::println(
+                "Device memory: {} buffers in {} device allocations, {} of {} bytes used, {:.1f}% internal and {:.1f}% external fragmentation",
+                stats.allocationCount,
+                stats.deviceAllocationCount,
+                stats.requestedBytes,
+                stats.reservedBytes,
+                100.0 * stats.getInternalFragmentation(),
+                100.0 * stats.getExternalFragmentation()
+            );
         }
 
         void mainLoop() {
+            if (m_settings.headless) {
+                this->mainLoopHeadless();
+            } else {
+                this->mainLoopWindowed();
+            }
+        }
+
+        void mainLoopHeadless() {
+            const auto startTime = std::chrono::steady_clock::now();
+
+            m_lastFrameTime = HEADLESS_FRAME_TIME;
+            for (uint32_t step = 0; step < m_settings.headlessStepCount; step++) {
+                this->beginFrame();
+                this->simulate();
+                if (m_settings.verify) {
+                    this->verifyComputeStep(step);
+                }
+
+                this->advanceFrame();
+            }
+
+            if (m_engine) {
+                m_frameScheduler->waitIdle();
+                vkDeviceWaitIdle(m_engine->getLogicalDevice());
+            }
+
+            const auto elapsedTime = std::chrono::duration<double, std::milli> { std::chrono::steady_clock::now() - startTime };
+            fmt::println(
+                "Simulated {} steps of {} particles in {:.3f} ms",
+                m_settings.headlessStepCount,
+                m_settings.particleCount,
+                elapsedTime.count()
+            );
+            if (m_settings.simulationRate > 0) {
+                fmt::println("Ran {} fixed substeps at {} Hz", m_totalSubstepCount, m_settings.simulationRate);
+            }
+            this->printFramePacingStats();
+            this->reportGpuProfile();
+        }
+
+        // Compares one compute step against the CPU reference integrator, starting from the particles 
+        // the GPU read, so rounding differences cannot accumulate across steps.
+        void verifyComputeStep(uint32_t step) {
+            vkDeviceWaitIdle(m_engine->getLogicalDevice());
+
+            const size_t lastFrame = this->getPreviousFrameSlot(m_currentFrame);
+            auto particlesIn = std::vector<Particle> { m_settings.particleCount };
+            auto particlesOut = std::vector<Particle> { m_settings.particleCount };
+            this->_downloadShaderStorageBuffer(m_shaderStorageBuffers[lastFrame], particlesIn);
+            this->_downloadShaderStorageBuffer(m_shaderStorageBuffers[m_currentFrame], particlesOut);
+
+            // Every substep after the first integrates the particles in place.
+            auto expectedParticles = particlesIn;
+            for (uint32_t substep = 0; substep < m_substepCount; substep++) {
+                m_particleIntegrator.integrate(expectedParticles, expectedParticles, this->getSimulationTimeStep());
+            }
+
+            const auto comparison = compareParticles(expectedParticles, particlesOut, VERIFY_TOLERANCE);
+            if (!comparison.isMatch()) {
+                throw std::runtime_error(fmt::format(
+                    "compute step {} diverged from the CPU reference in {} particles, first at particle {}, with a maximum error of {}!",
+                    step,
+                    comparison.mismatchCount,
+                    comparison.firstMismatchIndex,
+                    comparison.maxAbsoluteError
+                ));
+            }
+        }
+
+        void mainLoopWindowed() {
             while (!glfwWindowShouldClose(m_engine->getWindow())) {
+                // In the low latency and fixed rate modes this is where the host waits for the GPU, so that the 
+                // input below is as fresh as possible.
+                this->beginFrame();
                 glfwPollEvents();
                 this->draw();
                 // We want to animate the particle system using the last frames time to get smooth, frame-rate 
@@ -231,12 +813,77 @@ class App final {
                 double currentTime = glfwGetTime();
                 m_lastFrameTime = (currentTime - m_lastTime) * 1000.0;
                 m_lastTime = currentTime;
+                if (m_settings.framePacing == FramePacing::FixedRate) {
+                    // Frames start at a fixed rate, so every frame advances the simulation by the same step.
+                    m_lastFrameTime = 1000.0f / static_cast<float>(m_settings.targetFrameRate);
+                }
             }
 
+            m_frameScheduler->waitIdle();
             vkDeviceWaitIdle(m_engine->getLogicalDevice());
+
+            this->printFramePacingStats();
+            this->reportGpuProfile();
+        }
+
+        void printFramePacingStats() const {
+            if (!m_frameScheduler) {
+                return;
+            }
+
+            const auto pacingName = [this]() -> std::string_view {
+                switch (m_settings.framePacing) {
+                    case FramePacing::LowLatency: return "low-latency";
+                    case FramePacing::Throughput: return "throughput";
+                    case FramePacing::FixedRate: return "fixed-rate";
+                }
+
+                return "unknown";
+            }();
+
+            const auto stats = m_frameScheduler->getPacingStats();
+            fmt::println(
+                "Frame pacing {} with {} frames in flight: {} frames at {:.1f} frames/s, {:.3f} ms average and {:.3f} ms worst frame latency",
+                pacingName,
+                m_settings.framesInFlight,
+                stats.frameCount,
+                stats.getFramesPerSecond(),
+                stats.averageLatencyMilliseconds,
+                stats.maxLatencyMilliseconds
+            );
         }
 
 
+        // Prints the GPU time of each pass over the last frames, and writes the trace of every pass if asked to.
+        // Only called once the device is idle, so every submitted pass has been read back.
+        void reportGpuProfile() {
+            if (!m_gpuProfiler) {
+                return;
+            }
+
+            m_gpuProfiler->collect();
+
+            for (const auto& stats : m_gpuProfiler->getStats()) {
+                if (stats.sampleCount == 0) {
+                    continue;
+                }
+
+                fmt::println(
+                    "GPU time of {} over the last {} frames: {:.3f} ms average, {:.3f} ms best and {:.3f} ms worst",
+                    stats.name,
+                    stats.windowSampleCount,
+                    stats.averageMilliseconds,
+                    stats.minMilliseconds,
+                    stats.maxMilliseconds
+                );
+            }
+
+            if (m_settings.gpuTraceFile.has_value()) {
+                m_gpuProfiler->writeChromeTrace(std::filesystem::path { *m_settings.gpuTraceFile });
+                fmt::println("Wrote GPU trace to `{}`", *m_settings.gpuTraceFile);
+            }
+        }
+
         void cleanupSwapChain() {
             for (auto framebuffer : m_swapChainFramebuffers) {
                 vkDestroyFramebuffer(m_engine->getLogicalDevice(), framebuffer, nullptr);
@@ -251,54 +898,107 @@ class App final {
 
 
         void cleanup() {
-            if (m_engine->isInitialized()) {
-                this->cleanupSwapChain();
+            // Stop rebuilding pipelines before anything they are built from goes away.
+            m_shaderHotReloader.reset();
+
+            if (m_engine && m_engine->isInitialized()) {
+                m_uploadManager.reset();
+                m_frameScheduler.reset();
+                m_gpuProfiler.reset();
+                m_commandBuffers.reset();
+                m_computeCommandBuffers.reset();
+
+                if (!m_engine->isHeadless()) {
+                    this->cleanupSwapChain();
+
+                    vkDestroyPipeline(m_engine->getLogicalDevice(), m_graphicsPipeline, nullptr);
+                    vkDestroyPipelineLayout(m_engine->getLogicalDevice(), m_graphicsPipelineLayout, nullptr);
 
-                vkDestroyPipeline(m_engine->getLogicalDevice(), m_graphicsPipeline, nullptr);
-                vkDestroyPipelineLayout(m_engine->getLogicalDevice(), m_graphicsPipelineLayout, nullptr);
+                    vkDestroyRenderPass(m_engine->getLogicalDevice(), m_renderPass, nullptr);
+                }
 
                 vkDestroyPipeline(m_engine->getLogicalDevice(), m_computePipeline, nullptr);
                 vkDestroyPipelineLayout(m_engine->getLogicalDevice(), m_computePipelineLayout, nullptr);
 
-                vkDestroyRenderPass(m_engine->getLogicalDevice(), m_renderPass, nullptr);
+                for (const auto& reloadedPipeline : m_reloadedPipelines) {
+                    vkDestroyPipeline(m_engine->getLogicalDevice(), reloadedPipeline.pipeline, nullptr);
+                }
+
+                for (const auto& retiredPipeline : m_retiredPipelines) {
+                    vkDestroyPipeline(m_engine->getLogicalDevice(), retiredPipeline.pipeline, nullptr);
+                }
 
                 for (size_t i = 0; i < m_uniformBuffers.size(); i++) {
                     vkDestroyBuffer(m_engine->getLogicalDevice(), m_uniformBuffers[i], nullptr);
-                    vkFreeMemory(m_engine->getLogicalDevice(), m_uniformBuffersMemory[i], nullptr);
+                    m_engine->freeMemory(m_uniformBuffersMemory[i]);
                 }
 
                 vkDestroyDescriptorPool(m_engine->getLogicalDevice(), m_descriptorPool, nullptr);
       
                 vkDestroyDescriptorSetLayout(m_engine->getLogicalDevice(), m_computeDescriptorSetLayout, nullptr);
 
-                for (size_t i = 0; i < m_uniformBuffers.size(); i++) {
+                for (size_t i = 0; i < m_shaderStorageBuffers.size(); i++) {
                     vkDestroyBuffer(m_engine->getLogicalDevice(), m_shaderStorageBuffers[i], nullptr);
-                    vkFreeMemory(m_engine->getLogicalDevice(), m_shaderStorageBuffersMemory[i], nullptr);
+                    m_engine->freeMemory(m_shaderStorageBuffersMemory[i]);
                 }
 
-                for (size_t i = 0; i < m_uniformBuffers.size(); i++) {
-                    vkDestroySemaphore(m_engine->getLogicalDevice(), m_renderFinishedSemaphores[i], nullptr);
-                    vkDestroySemaphore(m_engine->getLogicalDevice(), m_imageAvailableSemaphores[i], nullptr);
-                    vkDestroySemaphore(m_engine->getLogicalDevice(), m_computeFinishedSemaphores[i], nullptr);
-                    vkDestroyFence(m_engine->getLogicalDevice(), m_inFlightFences[i], nullptr);
-                    vkDestroyFence(m_engine->getLogicalDevice(), m_computeInFlightFences[i], nullptr);
+                for (size_t i = 0; i < m_positionStorageBuffers.size(); i++) {
+                    vkDestroyBuffer(m_engine->getLogicalDevice(), m_positionStorageBuffers[i], nullptr);
+                    m_engine->freeMemory(m_positionStorageBuffersMemory[i]);
+                    vkDestroyBuffer(m_engine->getLogicalDevice(), m_velocityStorageBuffers[i], nullptr);
+                    m_engine->freeMemory(m_velocityStorageBuffersMemory[i]);
                 }
+
+                vkDestroyBuffer(m_engine->getLogicalDevice(), m_colorBuffer, nullptr);
+                m_engine->freeMemory(m_colorBufferMemory);
             }
         }
 
         void createEngine() {
+            if (m_settings.headless) {
+                auto engine = Engine::createHeadless();
+
+                m_engine = std::move(engine);
+
+                return;
+            }
+
             auto engine = Engine::createDebugMode();
             engine->createWindow(WIDTH, HEIGHT, "Compute Shaders");
 
             m_engine = std::move(engine);
         }
 
-        void createShaderBinaries() {
-            const auto glslShaders = shaders_glsl::createGlslShaders();
-            const auto hlslShaders = shaders_hlsl::createHlslShaders();
+        void loadPipelineCache() {
+            if (!m_settings.usePipelineCache) {
+                return;
+            }
+
+            const auto filePath = [this]() -> std::filesystem::path {
+                if (m_settings.pipelineCacheFile.has_value()) {
+                    return std::filesystem::path { m_settings.pipelineCacheFile.value() };
+                }
+
+                return std::filesystem::temp_directory_path() / DEFAULT_PIPELINE_CACHE_FILE_NAME;
+            }();
+
+            m_engine->loadPipelineCache(filePath);
+        }
+
+        void savePipelineCache() {
+            // Save as soon as every pipeline exists instead of on exit, so that instances launched while this
+            // one is still running already start from a warm cache.
+            try {
+                m_engine->getPipelineCache().save();
+            } catch (const std::runtime_error& exception) {
+                fmt::println(std::cerr, "{}", exception.what());
+            }
+        }
+
+        void createUploadManager() {
+            auto uploadManager = std::make_unique<UploadManager>(*m_engine);
 
-            m_glslShaders = std::move(glslShaders);
-            m_hlslShaders = std::move(hlslShaders);
+            m_uploadManager = std::move(uploadManager);
         }
 
         VkSurfaceFormatKHR selectSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
@@ -529,45 +1229,6 @@ class App final {
             m_swapChainFramebuffers = std::move(swapChainFramebuffers);
         }
 
-        void createGraphicsSyncObjects() {
-            auto imageAvailableSemaphores = std::vector<VkSemaphore> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            auto renderFinishedSemaphores = std::vector<VkSemaphore> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            auto inFlightFences = std::vector<VkFence> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-
-            const auto semaphoreInfo = VkSemaphoreCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-            };
-            const auto fenceInfo = VkFenceCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-                .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-            };
-
-            for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
-                const auto result = vkCreateSemaphore(m_engine->getLogicalDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]);
-                if (result != VK_SUCCESS) {
-                    throw std::runtime_error("failed to create image available semaphore for a frame");
-                }
-            }
-
-            for (size_t i = 0; i < renderFinishedSemaphores.size(); i++) {
-                const auto result = vkCreateSemaphore(m_engine->getLogicalDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]);
-                if (result != VK_SUCCESS) {
-                    throw std::runtime_error("failed to create render finished semaphore for a frame");
-                }
-            }
-
-            for (size_t i = 0; i < inFlightFences.size(); i++) {
-                const auto result = vkCreateFence(m_engine->getLogicalDevice(), &fenceInfo, nullptr, &inFlightFences[i]);
-                if (result != VK_SUCCESS) {
-                    throw std::runtime_error("failed to create in-flight semaphore for a frame");
-                }
-            }
-
-            m_imageAvailableSemaphores = std::move(imageAvailableSemaphores);
-            m_renderFinishedSemaphores = std::move(renderFinishedSemaphores);
-            m_inFlightFences = std::move(inFlightFences);
-        }
-
         void recreateSwapChain() {
             int width = 0;
             int height = 0;
@@ -584,55 +1245,126 @@ class App final {
             this->createSwapChain();
             this->createSwapChainImageViews();
             this->createSwapChainFramebuffers();
+
+            // The recorded draws refer to the old framebuffers and extent.
+            m_commandBuffers->invalidate(static_cast<uint32_t>(m_swapChainImages.size()));
         }
 
 
 
         void createComputeDescriptorSetLayout() {
-            const auto layoutBindings = std::array<VkDescriptorSetLayoutBinding, 3> {
-                VkDescriptorSetLayoutBinding {
-                    .binding = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .pImmutableSamplers = nullptr,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                },
-                VkDescriptorSetLayoutBinding {
-                    .binding = 1,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .pImmutableSamplers = nullptr,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                },
-                VkDescriptorSetLayoutBinding {
-                    .binding = 2,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .pImmutableSamplers = nullptr,
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                }
-            };
+            const auto& reflection = this->getComputeShaderReflection();
+            if (reflection.getDescriptorSetNumbers() != std::vector<uint32_t> { 0 }) {
+                throw std::runtime_error("compute shader must declare all of its resources in descriptor set 0!");
+            }
 
-            const auto layoutInfo = VkDescriptorSetLayoutCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-                .bindingCount = 3,
+            m_computeDescriptorSetLayout = this->createDescriptorSetLayout(reflection, 0);
+        }
+
+        const ShaderReflection& getComputeShaderReflection() const {
+            return m_engine->reflectShader(this->getShaderCode(this->getComputeShaderKey()), ShaderCodeLifetime::Static);
+        }
+
+        const ShaderReflection& getInitShaderReflection() const {
+            return m_engine->reflectShader(
+                this->getShaderCode(shaders_glsl::shaderKey("shader_init.comp.glsl")),
+                ShaderCodeLifetime::Static
+            );
+        }
+
+        // Creates the layout of descriptor set `set` with the bindings the shader declares for it.
+        VkDescriptorSetLayout createDescriptorSetLayout(const ShaderReflection& reflection, uint32_t set) const {
+            const auto layoutBindings = reflection.getDescriptorSetLayoutBindings(set);
+            const auto layoutInfo = VkDescriptorSetLayoutCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .bindingCount = static_cast<uint32_t>(layoutBindings.size()),
                 .pBindings = layoutBindings.data(),
             };
 
-            auto computeDescriptorSetLayout = VkDescriptorSetLayout {};
-            const auto result = vkCreateDescriptorSetLayout(m_engine->getLogicalDevice(), &layoutInfo, nullptr, &computeDescriptorSetLayout);
+            auto descriptorSetLayout = VkDescriptorSetLayout {};
+            const auto result = vkCreateDescriptorSetLayout(m_engine->getLogicalDevice(), &layoutInfo, nullptr, &descriptorSetLayout);
             if (result != VK_SUCCESS) {
-                throw std::runtime_error("failed to create compute descriptor set layout!");
+                throw std::runtime_error("failed to create descriptor set layout!");
             }
 
-            m_computeDescriptorSetLayout = computeDescriptorSetLayout;
+            return descriptorSetLayout;
         }
 
+        // Creates a pipeline layout with the given descriptor set layouts and the push constants the shader declares.
+        VkPipelineLayout createPipelineLayout(const ShaderReflection& reflection, std::span<const VkDescriptorSetLayout> descriptorSetLayouts) const {
+            const auto pushConstantRanges = reflection.getPushConstantRanges();
+            const auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                .setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+                .pSetLayouts = descriptorSetLayouts.data(),
+                .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+                .pPushConstantRanges = pushConstantRanges.data(),
+            };
+
+            auto pipelineLayout = VkPipelineLayout {};
+            const auto result = vkCreatePipelineLayout(m_engine->getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline layout!");
+            }
+
+            return pipelineLayout;
+        }
+
+
+        std::tuple<std::vector<VkVertexInputBindingDescription>, std::vector<VkVertexInputAttributeDescription>> getVertexInputDescriptions() const {
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                const auto bindingDescriptions = ParticleArrays::getBindingDescriptions();
+                const auto attributeDescriptions = ParticleArrays::getAttributeDescriptions();
+
+                return std::make_tuple(
+                    std::vector<VkVertexInputBindingDescription> { bindingDescriptions.begin(), bindingDescriptions.end() },
+                    std::vector<VkVertexInputAttributeDescription> { attributeDescriptions.begin(), attributeDescriptions.end() }
+                );
+            }
+
+            const auto bindingDescription = Particle::getBindingDescription();
+            const auto attributeDescriptions = Particle::getAttributeDescriptions();
+
+            return std::make_tuple(
+                std::vector<VkVertexInputBindingDescription> { bindingDescription },
+                std::vector<VkVertexInputAttributeDescription> { attributeDescriptions.begin(), attributeDescriptions.end() }
+            );
+        }
 
         void createGraphicsPipeline() {
-            const auto vertexShaderModule = m_engine->createShaderModule(m_glslShaders.at("shader_compute.vert.glsl"));
-            const auto fragmentShaderModule = m_engine->createShaderModule(m_glslShaders.at("shader_compute.frag.glsl"));
+            const auto vertexShaderModule = m_engine->createShaderModule(this->getShaderCode(VERTEX_SHADER_KEY), ShaderCodeLifetime::Static);
+            const auto fragmentShaderModule = m_engine->createShaderModule(this->getShaderCode(FRAGMENT_SHADER_KEY), ShaderCodeLifetime::Static);
+
+            const auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                .setLayoutCount = 0,
+                .pSetLayouts = nullptr,
+            };
+
+            auto graphicsPipelineLayout = VkPipelineLayout {};
+            const auto resultCreatePipelineLayout = vkCreatePipelineLayout(
+                m_engine->getLogicalDevice(),
+                &pipelineLayoutInfo,
+                nullptr,
+                &graphicsPipelineLayout
+            );
+
+            if (resultCreatePipelineLayout != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline layout!");
+            }
+
+            const auto graphicsPipeline = this->buildGraphicsPipeline(graphicsPipelineLayout, vertexShaderModule, fragmentShaderModule);
+
+            // The pipeline no longer needs the modules, but the device keeps them cached for the next pipeline
+            // built from the same code.
+            m_engine->releaseShaderModule(vertexShaderModule);
+            m_engine->releaseShaderModule(fragmentShaderModule);
+
+            m_graphicsPipelineLayout = graphicsPipelineLayout;
+            m_graphicsPipeline = graphicsPipeline;
+        }
 
+        VkPipeline buildGraphicsPipeline(VkPipelineLayout pipelineLayout, VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule) const {
             const auto vertShaderStageInfo = VkPipelineShaderStageCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                 .stage = VK_SHADER_STAGE_VERTEX_BIT,
@@ -649,14 +1381,13 @@ class App final {
 
             const auto shaderStages = std::array<VkPipelineShaderStageCreateInfo, 2> { vertShaderStageInfo, fragShaderStageInfo };
 
-            const auto bindingDescription = Particle::getBindingDescription();
-            const auto attributeDescriptions = Particle::getAttributeDescriptions();
+            const auto [bindingDescriptions, attributeDescriptions] = this->getVertexInputDescriptions();
 
             const auto vertexInputInfo = VkPipelineVertexInputStateCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-                .vertexBindingDescriptionCount = 1,
+                .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()),
+                .pVertexBindingDescriptions = bindingDescriptions.data(),
                 .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
-                .pVertexBindingDescriptions = &bindingDescription,
                 .pVertexAttributeDescriptions = attributeDescriptions.data(),
             };
 
@@ -722,24 +1453,6 @@ class App final {
                 .pDynamicStates = dynamicStates.data(),
             };
 
-            const auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-                .setLayoutCount = 0,
-                .pSetLayouts = nullptr,
-            };
-
-            auto graphicsPipelineLayout = VkPipelineLayout {};
-            const auto resultCreatePipelineLayout = vkCreatePipelineLayout(
-                m_engine->getLogicalDevice(),
-                &pipelineLayoutInfo,
-                nullptr,
-                &graphicsPipelineLayout
-            );
-
-            if (resultCreatePipelineLayout != VK_SUCCESS) {
-                throw std::runtime_error("failed to create pipeline layout!");
-            }
-
             const auto pipelineInfo = VkGraphicsPipelineCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
                 .stageCount = 2,
@@ -751,7 +1464,7 @@ class App final {
                 .pMultisampleState = &multisampling,
                 .pColorBlendState = &colorBlending,
                 .pDynamicState = &dynamicState,
-                .layout = graphicsPipelineLayout,
+                .layout = pipelineLayout,
                 .renderPass = m_renderPass,
                 .subpass = 0,
                 .basePipelineHandle = VK_NULL_HANDLE,
@@ -760,7 +1473,7 @@ class App final {
             auto graphicsPipeline = VkPipeline {};
             const auto resultCreateGraphicsPipelines = vkCreateGraphicsPipelines(
                 m_engine->getLogicalDevice(),
-                VK_NULL_HANDLE,
+                m_engine->getPipelineCache().getHandle(),
                 1,
                 &pipelineInfo, 
                 nullptr,
@@ -771,127 +1484,922 @@ class App final {
                 throw std::runtime_error("failed to create graphics pipeline!");
             }
 
-            m_graphicsPipelineLayout = graphicsPipelineLayout;
-            m_graphicsPipeline = graphicsPipeline;
+            return graphicsPipeline;
         }
 
         void createComputePipeline() {
-            const auto computeShaderModule = m_engine->createShaderModule(m_hlslShaders.at("shader_compute.comp.hlsl"));
+            const auto computeShaderModule = m_engine->createShaderModule(this->getShaderCode(this->getComputeShaderKey()), ShaderCodeLifetime::Static);
+            const auto computePipelineLayout = this->createPipelineLayout(
+                this->getComputeShaderReflection(),
+                std::span<const VkDescriptorSetLayout> { &m_computeDescriptorSetLayout, 1 }
+            );
+
+            const auto computePipeline = this->buildComputePipeline(computePipelineLayout, computeShaderModule, m_computeWorkgroupSize);
+
+            m_engine->releaseShaderModule(computeShaderModule);
 
+            m_computePipelineLayout = computePipelineLayout;
+            m_computePipeline = computePipeline;
+        }
+
+        std::string_view getComputeShaderName() const {
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                return "shader_compute_soa.comp.glsl";
+            } else {
+                return "shader_compute.comp.glsl";
+            }
+        }
+
+        uint64_t getComputeShaderKey() const {
+            return shaders_glsl::hashShaderFileName(this->getComputeShaderName());
+        }
+
+        void openShaderArchive() {
+            if (!m_settings.shaderArchiveFile.has_value()) {
+                return;
+            }
+
+            m_shaderArchive = std::make_unique<ShaderArchive>(std::filesystem::path { *m_settings.shaderArchiveFile });
+
+            // The archive is matched against the embedded shaders by file name, so it can hold the shaders of
+            // other programs as well.
+            for (const auto& shader : shaders_glsl::getShaders()) {
+                const auto archivedCode = m_shaderArchive->findShader(shader.fileName);
+                if (archivedCode.has_value()) {
+                    m_archivedShaders.insert_or_assign(shader.key, *archivedCode);
+                }
+            }
+
+            fmt::println(
+                "Replacing {} of {} embedded shaders with shaders from `{}`",
+                m_archivedShaders.size(),
+                shaders_glsl::getShaders().size(),
+                m_shaderArchive->getFilePath().string()
+            );
+        }
+
+        // The code of a shader, from the shader archive when it replaces the embedded shader.
+        std::span<const uint32_t> getShaderCode(uint64_t shaderKey) const {
+            const auto archivedCode = m_archivedShaders.find(shaderKey);
+            if (archivedCode != m_archivedShaders.end()) {
+                return archivedCode->second;
+            }
+
+            return shaders_glsl::getShader(shaderKey);
+        }
+
+        VkPipeline buildComputePipeline(VkPipelineLayout pipelineLayout, VkShaderModule computeShaderModule, uint32_t workgroupSize) const {
+            const auto specializationMapEntry = VkSpecializationMapEntry {
+                .constantID = COMPUTE_WORKGROUP_SIZE_CONSTANT_ID,
+                .offset = 0,
+                .size = sizeof(uint32_t),
+            };
+            const auto specializationInfo = VkSpecializationInfo {
+                .mapEntryCount = 1,
+                .pMapEntries = &specializationMapEntry,
+                .dataSize = sizeof(uint32_t),
+                .pData = &workgroupSize,
+            };
             const auto computeShaderStageInfo = VkPipelineShaderStageCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                 .stage = VK_SHADER_STAGE_COMPUTE_BIT,
                 .module = computeShaderModule,
                 .pName = "main",
+                .pSpecializationInfo = &specializationInfo,
             };
 
-            const auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-                .setLayoutCount = 1,
-                .pSetLayouts = &m_computeDescriptorSetLayout,
-            };
-
-            auto computePipelineLayout = VkPipelineLayout {};
-            const auto resultCreatePipelineLayout = vkCreatePipelineLayout(
-                m_engine->getLogicalDevice(),
-                &pipelineLayoutInfo,
-                nullptr,
-                &computePipelineLayout
-            );
-        
-            if (resultCreatePipelineLayout != VK_SUCCESS) {
-                throw std::runtime_error("failed to create compute pipeline layout!");
-            }
-
             const auto pipelineInfo = VkComputePipelineCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-                .layout = computePipelineLayout,
+                .layout = pipelineLayout,
                 .stage = computeShaderStageInfo,
             };
 
             auto computePipeline = VkPipeline {};
             const auto resultCreateComputePipelines = vkCreateComputePipelines(
                 m_engine->getLogicalDevice(),
-                VK_NULL_HANDLE,
+                m_engine->getPipelineCache().getHandle(),
                 1,
                 &pipelineInfo,
                 nullptr,
                 &computePipeline
             );
-        
-            if (resultCreateComputePipelines != VK_SUCCESS) {
-                throw std::runtime_error("failed to create compute pipeline!");
+        
+            if (resultCreateComputePipelines != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compute pipeline!");
+            }
+
+            return computePipeline;
+        }
+
+        void createShaderHotReloader() {
+            if (!m_settings.watchShaderDirectory.has_value()) {
+                return;
+            }
+
+            m_shaderHotReloader = std::make_unique<ShaderHotReloader>(
+                std::filesystem::path { *m_settings.watchShaderDirectory },
+                [this](const std::filesystem::path& sourceFile, const std::filesystem::path& spirvFile) {
+                    this->rebuildPipelineForShader(sourceFile, spirvFile);
+                }
+            );
+
+            fmt::println("Watching `{}` for shader changes", m_shaderHotReloader->getShaderDirectory().string());
+        }
+
+        // Runs on the reloader's thread, and rebuilds the pipeline using the reloaded shader with the existing
+        // layout. The pipeline is handed over to the main thread, which swaps it in at the next frame boundary.
+        void rebuildPipelineForShader(const std::filesystem::path& sourceFile, const std::filesystem::path& spirvFile) {
+            const auto shaderName = sourceFile.filename().string();
+            const uint64_t shaderKey = shaders_glsl::hashShaderFileName(shaderName);
+            const bool isComputeShader = shaderKey == this->getComputeShaderKey();
+            const bool isGraphicsShader = !m_engine->isHeadless() && (shaderKey == VERTEX_SHADER_KEY || shaderKey == FRAGMENT_SHADER_KEY);
+            if (!isComputeShader && !isGraphicsShader) {
+                fmt::println("Shader `{}` is not used in this configuration, ignoring the change", shaderName);
+
+                return;
+            }
+
+            auto code = this->loadReloadedShaderCode(spirvFile);
+
+            // The layouts stay the ones built from the shader the demo started with, so a shader that declares
+            // anything else would not fit them.
+            const auto& reflection = m_engine->reflectShader(code, ShaderCodeLifetime::Transient);
+            const auto& originalReflection = m_engine->reflectShader(this->getShaderCode(shaderKey), ShaderCodeLifetime::Static);
+            if (!reflection.hasSameInterface(originalReflection)) {
+                fmt::println(
+                    std::cerr,
+                    "Shader `{}` changed its bindings, push constants, or specialization constants, which takes a restart; "
+                    "keeping the previous version",
+                    shaderName
+                );
+
+                return;
+            }
+
+            auto reloadedPipeline = ReloadedPipeline {};
+            if (isComputeShader) {
+                const auto computeShaderModule = ShaderModuleReference {
+                    *m_engine,
+                    m_engine->createShaderModule(code, ShaderCodeLifetime::Transient)
+                };
+                reloadedPipeline = ReloadedPipeline {
+                    .bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE,
+                    .pipeline = this->buildComputePipeline(m_computePipelineLayout, computeShaderModule.get(), m_computeWorkgroupSize),
+                };
+            } else {
+                const auto vertexShaderModule = this->createReloadedShaderModule(VERTEX_SHADER_KEY, shaderKey, code);
+                const auto fragmentShaderModule = this->createReloadedShaderModule(FRAGMENT_SHADER_KEY, shaderKey, code);
+                reloadedPipeline = ReloadedPipeline {
+                    .bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    .pipeline = this->buildGraphicsPipeline(m_graphicsPipelineLayout, vertexShaderModule.get(), fragmentShaderModule.get()),
+                };
+            }
+
+            m_reloadedShaderCode.insert_or_assign(shaderKey, std::move(code));
+
+            // The modules of the replaced shaders are never asked for again.
+            m_engine->evictUnusedShaderModules();
+
+            {
+                auto lock = std::unique_lock<std::mutex> { m_reloadedPipelinesMutex };
+                m_reloadedPipelines.push_back(reloadedPipeline);
+            }
+
+            fmt::println("Reloaded shader `{}`", shaderName);
+        }
+
+        // The code is copied out of the file, since the next compile of the shader overwrites it.
+        std::vector<uint32_t> loadReloadedShaderCode(const std::filesystem::path& spirvFile) const {
+            const auto mappedFile = MappedFile { spirvFile };
+            const auto bytes = mappedFile.getBytes();
+            if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+                throw std::runtime_error(fmt::format("`{}` is not a whole number of SPIR-V words!", spirvFile.string()));
+            }
+
+            auto code = std::vector<uint32_t>(bytes.size() / sizeof(uint32_t));
+            memcpy(code.data(), bytes.data(), bytes.size());
+
+            return code;
+        }
+
+        // The stage that was just reloaded uses its new code. The other stage comes from its last reload, or from
+        // the shader archive or the binary embedded at build time.
+        ShaderModuleReference createReloadedShaderModule(uint64_t shaderKey, uint64_t reloadedShaderKey, std::span<const uint32_t> reloadedCode) {
+            if (shaderKey == reloadedShaderKey) {
+                return ShaderModuleReference { *m_engine, m_engine->createShaderModule(reloadedCode, ShaderCodeLifetime::Transient) };
+            }
+
+            const auto lastReloadedCode = m_reloadedShaderCode.find(shaderKey);
+            if (lastReloadedCode != m_reloadedShaderCode.end()) {
+                return ShaderModuleReference { *m_engine, m_engine->createShaderModule(lastReloadedCode->second, ShaderCodeLifetime::Transient) };
+            }
+
+            return ShaderModuleReference { *m_engine, m_engine->createShaderModule(this->getShaderCode(shaderKey), ShaderCodeLifetime::Static) };
+        }
+
+
+
+
+        void _createShaderStorageBuffer(VkDeviceSize bufferSize, VkBuffer& storageBuffer, MemoryAllocation& storageBufferMemory) {
+            const VkBufferUsageFlags usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            // The CPU backend writes every frame's particles straight into the buffer from the host.
+            const VkMemoryPropertyFlags propertyFlags = [this]() -> VkMemoryPropertyFlags {
+                if (m_settings.simulationBackend == SimulationBackend::Cpu) {
+                    return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                } else {
+                    return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+                }
+            }();
+            this->createBuffer(
+                bufferSize,
+                usageFlags,
+                propertyFlags,
+                this->getSharedBufferQueueFamilies(),
+                storageBuffer,
+                storageBufferMemory
+            );
+        }
+
+        // The particle buffers are filled by the transfer queue, written by the compute queue, read by the graphics
+        // queue as vertex buffers, and copied back by the transfer queue again.
+        std::vector<uint32_t> getSharedBufferQueueFamilies() const {
+            const auto& indices = m_engine->getQueueFamilyIndices();
+            const auto queueFamilies = std::set<uint32_t> {
+                indices.graphicsAndComputeFamily.value(),
+                indices.getComputeFamily(),
+                indices.getTransferFamily()
+            };
+
+            return std::vector<uint32_t> { queueFamilies.begin(), queueFamilies.end() };
+        }
+
+        void _createShaderStorageBuffers(VkDeviceSize bufferSize, std::vector<VkBuffer>& storageBuffers, std::vector<MemoryAllocation>& storageBuffersMemory) {
+            auto shaderStorageBuffers = std::vector<VkBuffer> { this->getParticleBufferCount() };
+            auto shaderStorageBuffersMemory = std::vector<MemoryAllocation> { this->getParticleBufferCount() };
+
+            for (size_t i = 0; i < shaderStorageBuffers.size(); i++) {
+                this->_createShaderStorageBuffer(bufferSize, shaderStorageBuffers[i], shaderStorageBuffersMemory[i]);
+            }
+
+            storageBuffers = std::move(shaderStorageBuffers);
+            storageBuffersMemory = std::move(shaderStorageBuffersMemory);
+        }
+
+        // Queues the copies on the upload manager. They are submitted on the next flush.
+        template <typename T>
+        void _uploadShaderStorageBuffers(const std::vector<VkBuffer>& shaderStorageBuffers, const std::vector<T>& elements) {
+            const auto bufferSize = VkDeviceSize { sizeof(T) * elements.size() };
+
+            for (size_t i = 0; i < shaderStorageBuffers.size(); i++) {
+                m_uploadManager->upload(shaderStorageBuffers[i], 0, elements.data(), bufferSize);
+            }
+        }
+
+        template <typename T>
+        void _downloadShaderStorageBuffer(VkBuffer shaderStorageBuffer, std::vector<T>& elements) {
+            const auto bufferSize = VkDeviceSize { sizeof(T) * elements.size() };
+
+            // Create a staging buffer used to read data back from the gpu
+            auto stagingBuffer = VkBuffer {};
+            auto stagingBufferMemory = MemoryAllocation {};
+            this->createBuffer(
+                bufferSize,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                stagingBuffer,
+                stagingBufferMemory
+            );
+
+            this->copyBuffer(shaderStorageBuffer, stagingBuffer, bufferSize);
+
+            memcpy(elements.data(), stagingBufferMemory.mappedData, static_cast<size_t>(bufferSize));
+
+            vkDestroyBuffer(m_engine->getLogicalDevice(), stagingBuffer, nullptr);
+            m_engine->freeMemory(stagingBufferMemory);
+        }
+
+        void createComputeDispatchSize() {
+            auto physicalDeviceProperties = VkPhysicalDeviceProperties {};
+            vkGetPhysicalDeviceProperties(m_engine->getPhysicalDevice(), &physicalDeviceProperties);
+            const auto& limits = physicalDeviceProperties.limits;
+
+            const auto bufferSize = this->getParticleStorageBufferSize();
+            if (bufferSize > limits.maxStorageBufferRange) {
+                throw std::runtime_error(fmt::format(
+                    "{} particles need a {} byte storage buffer, but this device supports at most {} bytes!",
+                    m_settings.particleCount,
+                    bufferSize,
+                    limits.maxStorageBufferRange
+                ));
+            }
+
+            const auto groupCounts = this->getComputeGroupCounts(limits, m_computeWorkgroupSize);
+            if (!groupCounts.has_value()) {
+                throw std::runtime_error(fmt::format(
+                    "{} particles need more compute workgroups than this device can dispatch!",
+                    m_settings.particleCount
+                ));
+            }
+
+            m_computeGroupCountX = groupCounts->first;
+            m_computeGroupCountY = groupCounts->second;
+        }
+
+        // Decides on the workgroup size before any compute pipeline is built. Without a size from the command line
+        // or from an earlier run on this device, the pipelines start out with the default size, and the size is
+        // tuned once the particle buffers exist to run the benchmark on.
+        void selectComputeWorkgroupSize() {
+            auto workgroupSizeTuner = std::make_unique<WorkgroupSizeTuner>(
+                m_engine->getPhysicalDevice(),
+                std::filesystem::temp_directory_path() / WORKGROUP_SIZE_FILE_NAME
+            );
+
+            if (m_settings.computeWorkgroupSize.has_value()) {
+                if (*m_settings.computeWorkgroupSize > workgroupSizeTuner->getMaxWorkgroupSize()) {
+                    throw std::runtime_error(fmt::format(
+                        "workgroup size {} is larger than the {} invocations this device supports!",
+                        *m_settings.computeWorkgroupSize,
+                        workgroupSizeTuner->getMaxWorkgroupSize()
+                    ));
+                }
+
+                m_computeWorkgroupSize = *m_settings.computeWorkgroupSize;
+                m_computeWorkgroupSizeOrigin = WorkgroupSizeOrigin::CommandLine;
+
+                return;
+            }
+
+            m_computeWorkgroupSize = std::min(DEFAULT_COMPUTE_WORKGROUP_SIZE, workgroupSizeTuner->getMaxWorkgroupSize());
+
+            // The CPU backend never dispatches the simulation, so there is nothing to tune.
+            if (m_settings.simulationBackend == SimulationBackend::Cpu) {
+                return;
+            }
+
+            const auto tunedSize = workgroupSizeTuner->getTunedSize(this->getComputeShaderName());
+            if (tunedSize.has_value()) {
+                m_computeWorkgroupSize = *tunedSize;
+                m_computeWorkgroupSizeOrigin = WorkgroupSizeOrigin::Stored;
+            } else {
+                m_workgroupSizeTuner = std::move(workgroupSizeTuner);
+            }
+        }
+
+        // Times the simulation step with every candidate workgroup size, and keeps the pipeline of the fastest.
+        void tuneComputeWorkgroupSize() {
+            const auto startTime = std::chrono::steady_clock::now();
+
+            auto candidatePipelines = std::vector<std::pair<uint32_t, VkPipeline>> {};
+            const auto computeShaderModule = m_engine->createShaderModule(this->getShaderCode(this->getComputeShaderKey()), ShaderCodeLifetime::Static);
+            const uint32_t tunedSize = m_workgroupSizeTuner->tune(this->getComputeShaderName(), [&](uint32_t workgroupSize) {
+                const auto pipeline = this->buildComputePipeline(m_computePipelineLayout, computeShaderModule, workgroupSize);
+                candidatePipelines.emplace_back(workgroupSize, pipeline);
+
+                return this->benchmarkComputeWorkgroupSize(pipeline, workgroupSize);
+            });
+            m_engine->releaseShaderModule(computeShaderModule);
+
+            for (const auto& [workgroupSize, pipeline] : candidatePipelines) {
+                if (workgroupSize == tunedSize) {
+                    vkDestroyPipeline(m_engine->getLogicalDevice(), m_computePipeline, nullptr);
+                    m_computePipeline = pipeline;
+                } else {
+                    vkDestroyPipeline(m_engine->getLogicalDevice(), pipeline, nullptr);
+                }
+            }
+
+            m_computeWorkgroupSize = tunedSize;
+            m_computeWorkgroupSizeOrigin = WorkgroupSizeOrigin::Tuned;
+            m_workgroupSizeTuningTime = std::chrono::steady_clock::now() - startTime;
+            this->createComputeDispatchSize();
+
+            try {
+                m_workgroupSizeTuner->save();
+            } catch (const std::runtime_error& exception) {
+                // The tuned size still applies to this run, it just has to be tuned again next time.
+                fmt::println(std::cerr, "{}", exception.what());
+            }
+
+            m_workgroupSizeTuner.reset();
+        }
+
+        // Runs a batch of simulation steps on the first frame slot's descriptor set, which reads the last slot's
+        // particles and writes the first slot's. The input never changes, so every step writes the same
+        // particles, and the first frame overwrites them from the same input anyway. The batch runs on the compute
+        // queue the frames use, once to warm up and then `WORKGROUP_SIZE_BENCHMARK_RUN_COUNT` times, of which the
+        // fastest run counts. Each run is timed on the GPU with timestamp queries, so the submission and the wait
+        // are not part of the time. Only when the compute queue writes no timestamps is each run timed on the host.
+        std::chrono::steady_clock::duration benchmarkComputeWorkgroupSize(VkPipeline pipeline, uint32_t workgroupSize) {
+            auto physicalDeviceProperties = VkPhysicalDeviceProperties {};
+            vkGetPhysicalDeviceProperties(m_engine->getPhysicalDevice(), &physicalDeviceProperties);
+            const auto groupCounts = this->getComputeGroupCounts(physicalDeviceProperties.limits, workgroupSize);
+            if (!groupCounts.has_value()) {
+                return std::chrono::steady_clock::duration::max();
+            }
+
+            const auto [groupCountX, groupCountY] = *groupCounts;
+            const auto ubo = ComputeShaderUniformBufferObject {
+                .deltaTime = HEADLESS_FRAME_TIME,
+                .particleCount = m_settings.particleCount,
+                .groupCountX = groupCountX,
+            };
+            memcpy(m_uniformBuffersMapped[0], &ubo, sizeof(ubo));
+
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(m_engine->getPhysicalDevice(), &queueFamilyCount, nullptr);
+            auto queueFamilies = std::vector<VkQueueFamilyProperties>(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(m_engine->getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+            const uint32_t timestampValidBits = queueFamilies[m_engine->getQueueFamilyIndices().getComputeFamily()].timestampValidBits;
+
+            auto queryPool = VkQueryPool { VK_NULL_HANDLE };
+            if (timestampValidBits > 0) {
+                const auto queryPoolInfo = VkQueryPoolCreateInfo {
+                    .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                    .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                    .queryCount = 2,
+                };
+
+                const auto resultCreateQueryPool = vkCreateQueryPool(m_engine->getLogicalDevice(), &queryPoolInfo, nullptr, &queryPool);
+                if (resultCreateQueryPool != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create workgroup size benchmark query pool!");
+                }
+            }
+
+            const auto commandBufferAllocInfo = VkCommandBufferAllocateInfo {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = m_engine->getComputeCommandPool(),
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+
+            auto commandBuffer = VkCommandBuffer {};
+            const auto resultAllocateCommandBuffers = vkAllocateCommandBuffers(m_engine->getLogicalDevice(), &commandBufferAllocInfo, &commandBuffer);
+            if (resultAllocateCommandBuffers != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate workgroup size benchmark command buffer!");
+            }
+
+            const auto beginInfo = VkCommandBufferBeginInfo {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            };
+            const auto resultBeginCommandBuffer = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            if (resultBeginCommandBuffer != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording workgroup size benchmark command buffer!");
+            }
+
+            if (queryPool != VK_NULL_HANDLE) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+            }
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipelineLayout, 0, 1, &m_computeDescriptorSets[0], 0, nullptr);
+            for (uint32_t step = 0; step < WORKGROUP_SIZE_BENCHMARK_STEP_COUNT; step++) {
+                if (step > 0) {
+                    // Every step overwrites what the one before it wrote.
+                    const auto stepBarrier = VkMemoryBarrier {
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                        .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                    };
+                    vkCmdPipelineBarrier(
+                        commandBuffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        1, &stepBarrier,
+                        0, nullptr,
+                        0, nullptr
+                    );
+                }
+
+                vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+            }
+
+            if (queryPool != VK_NULL_HANDLE) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+            }
+
+            const auto resultEndCommandBuffer = vkEndCommandBuffer(commandBuffer);
+            if (resultEndCommandBuffer != VK_SUCCESS) {
+                throw std::runtime_error("failed to record workgroup size benchmark command buffer!");
+            }
+
+            const auto submitInfo = VkSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &commandBuffer,
+            };
+
+            auto fastestTime = std::chrono::steady_clock::duration::max();
+            for (uint32_t run = 0; run <= WORKGROUP_SIZE_BENCHMARK_RUN_COUNT; run++) {
+                if (queryPool != VK_NULL_HANDLE) {
+                    vkResetQueryPool(m_engine->getLogicalDevice(), queryPool, 0, 2);
+                }
+
+                const auto startTime = std::chrono::steady_clock::now();
+                const auto resultQueueSubmit = vkQueueSubmit(m_engine->getComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+                if (resultQueueSubmit != VK_SUCCESS) {
+                    throw std::runtime_error("failed to submit workgroup size benchmark command buffer!");
+                }
+
+                const auto resultQueueWaitIdle = vkQueueWaitIdle(m_engine->getComputeQueue());
+                if (resultQueueWaitIdle != VK_SUCCESS) {
+                    throw std::runtime_error("failed to wait for the workgroup size benchmark to finish!");
+                }
+
+                auto runTime = std::chrono::steady_clock::now() - startTime;
+
+                // The first run only warms up the caches and the pipeline.
+                if (run == 0) {
+                    continue;
+                }
+
+                if (queryPool != VK_NULL_HANDLE) {
+                    auto timestamps = std::array<uint64_t, 2> {};
+                    const auto resultGetQueryPoolResults = vkGetQueryPoolResults(
+                        m_engine->getLogicalDevice(),
+                        queryPool,
+                        0,
+                        2,
+                        sizeof(timestamps),
+                        timestamps.data(),
+                        sizeof(uint64_t),
+                        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+                    );
+                    if (resultGetQueryPoolResults != VK_SUCCESS) {
+                        throw std::runtime_error("failed to read workgroup size benchmark timestamps!");
+                    }
+
+                    // A timestamp with fewer than 64 valid bits wraps around, which the mask undoes.
+                    const uint64_t timestampMask = (timestampValidBits >= 64) ? UINT64_MAX : ((uint64_t { 1 } << timestampValidBits) - 1);
+                    const uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+                    const auto gpuTime = std::chrono::duration<double, std::nano> {
+                        static_cast<double>(ticks) * static_cast<double>(physicalDeviceProperties.limits.timestampPeriod)
+                    };
+                    runTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(gpuTime);
+                }
+
+                fastestTime = std::min(fastestTime, runTime);
+            }
+
+            vkFreeCommandBuffers(m_engine->getLogicalDevice(), m_engine->getComputeCommandPool(), 1, &commandBuffer);
+            vkDestroyQueryPool(m_engine->getLogicalDevice(), queryPool, nullptr);
+
+            return fastestTime;
+        }
+
+        // Round up so the particles in the last, partially filled workgroup are still updated. When there are
+        // more workgroups than fit in one dimension, the remainder wraps around into the y dimension.
+        std::optional<std::pair<uint32_t, uint32_t>> getComputeGroupCounts(const VkPhysicalDeviceLimits& limits, uint32_t workgroupSize) const {
+            const uint32_t groupCount = (m_settings.particleCount + workgroupSize - 1) / workgroupSize;
+            const uint32_t groupCountX = std::min(groupCount, limits.maxComputeWorkGroupCount[0]);
+            const uint32_t groupCountY = (groupCount + groupCountX - 1) / groupCountX;
+            if (groupCountY > limits.maxComputeWorkGroupCount[1]) {
+                return std::nullopt;
+            }
+
+            return std::make_pair(groupCountX, groupCountY);
+        }
+
+        // The size of one storage buffer the compute shader reads or writes. In the structure of arrays layout
+        // this is a single attribute array, so the shader only ever touches 16 of the 32 bytes per particle.
+        // Running more than one substep per frame on the GPU takes a scratch buffer per particle attribute 
+        // array, which sits right after the frame slots' buffers. All steps run on one queue, so every frame
+        // slot can share it.
+        bool hasScratchParticleBuffer() const {
+            return (m_settings.simulationBackend == SimulationBackend::Gpu) && (this->getMaxSubstepCount() > 1);
+        }
+
+        uint32_t getScratchParticleBuffer() const {
+            return this->getFrameSlotCount();
+        }
+
+        uint32_t getParticleBufferCount() const {
+            return this->getFrameSlotCount() + (this->hasScratchParticleBuffer() ? 1 : 0);
+        }
+
+        VkDeviceSize getParticleStorageBufferSize() const {
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                return VkDeviceSize { sizeof(glm::vec2) * m_settings.particleCount };
+            } else {
+                return VkDeviceSize { sizeof(Particle) * m_settings.particleCount };
+            }
+        }
+
+        void createShaderStorageBuffers() {
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                this->createShaderStorageBuffersSoA();
+            } else {
+                this->createShaderStorageBuffersAoS();
+            }
+        }
+
+        void createInitialParticleSource() {
+            if (m_settings.particlesFile.has_value()) {
+                // A particle file is the raw contents of an array of structures storage buffer.
+                const auto& fileName = *m_settings.particlesFile;
+                const auto fileSize = std::filesystem::file_size(fileName);
+                if (fileSize == 0 || fileSize % sizeof(Particle) != 0) {
+                    throw std::runtime_error(fmt::format("particle file `{}` does not hold a whole number of particles!", fileName));
+                }
+
+                const auto particleCount = fileSize / sizeof(Particle);
+                if (particleCount > std::numeric_limits<uint32_t>::max()) {
+                    throw std::runtime_error(fmt::format("particle file `{}` holds too many particles!", fileName));
+                }
+
+                m_settings.particleCount = static_cast<uint32_t>(particleCount);
+                fmt::println("Loading {} particles from `{}`", m_settings.particleCount, fileName);
+
+                return;
+            }
+
+            // Without an explicit seed every run starts differently. Print the seed so that any run can be 
+            // reproduced with `--seed`.
+            const uint64_t particleSeed = m_settings.seed.value_or(ParticleGenerator::createRandomSeed());
+            fmt::println("Generating {} particles with seed {}", m_settings.particleCount, particleSeed);
+
+            m_particleSeed = particleSeed;
+        }
+
+        float getAspectRatio() const {
+            return static_cast<float>(HEIGHT) / static_cast<float>(WIDTH);
+        }
+
+        ParticleGenerator createParticleGenerator() const {
+            return ParticleGenerator { m_particleSeed, this->getAspectRatio() };
+        }
+
+        std::vector<Particle> loadParticles() const {
+            const auto& fileName = *m_settings.particlesFile;
+            auto file = std::ifstream { fileName, std::ios::binary };
+            if (!file.is_open()) {
+                throw std::runtime_error(fmt::format("failed to open particle file `{}`!", fileName));
+            }
+
+            auto particles = std::vector<Particle> { m_settings.particleCount };
+            file.read(reinterpret_cast<char*>(particles.data()), sizeof(Particle) * particles.size());
+            if (!file) {
+                throw std::runtime_error(fmt::format("failed to read particle file `{}`!", fileName));
+            }
+
+            return particles;
+        }
+
+        std::vector<Particle> generateParticles() const {
+            if (m_settings.particlesFile.has_value()) {
+                return this->loadParticles();
+            }
+
+            const auto particleGenerator = this->createParticleGenerator();
+            auto threadPool = ThreadPool { m_settings.threadCount };
+            auto particles = std::vector<Particle> { m_settings.particleCount };
+            particleGenerator.generate(particles, threadPool);
+
+            return particles;
+        }
+
+        void createShaderStorageBuffersAoS() {
+            this->_createShaderStorageBuffers(this->getParticleStorageBufferSize(), m_shaderStorageBuffers, m_shaderStorageBuffersMemory);
+
+            if (m_settings.particleInit == ParticleInit::Gpu) {
+                this->initializeShaderStorageBuffersOnGpu();
+
+                return;
+            }
+
+            const auto particles = this->generateParticles();
+
+            if (m_settings.simulationBackend == SimulationBackend::Cpu) {
+                // The CPU backend's buffers are host visible, so the particles are written into them directly
+                // rather than through the staging ring.
+                this->createShaderStorageBuffersMapped();
+                for (auto* shaderStorageBufferMapped : m_shaderStorageBuffersMapped) {
+                    memcpy(shaderStorageBufferMapped, particles.data(), sizeof(Particle) * particles.size());
+                }
+
+                this->createCpuSimulation(particles);
+
+                return;
+            }
+
+            this->_uploadShaderStorageBuffers(m_shaderStorageBuffers, particles);
+        }
+
+        // Fills the first storage buffer with a one-off compute pass that generates the particles in place, and
+        // copies it into the buffers of the other frames in flight, so no particle data crosses the bus.
+        void initializeShaderStorageBuffersOnGpu() {
+            const auto& initReflection = this->getInitShaderReflection();
+            const auto pushConstantRanges = initReflection.getPushConstantRanges();
+            if (pushConstantRanges.size() != 1 || pushConstantRanges[0].size != sizeof(InitShaderPushConstants)) {
+                throw std::runtime_error("init shader push constants do not match `InitShaderPushConstants`!");
+            }
+
+            const auto initDescriptorSetLayout = this->createDescriptorSetLayout(initReflection, 0);
+            const auto initPipelineLayout = this->createPipelineLayout(
+                initReflection,
+                std::span<const VkDescriptorSetLayout> { &initDescriptorSetLayout, 1 }
+            );
+
+            // The init shader fills the particles with the same dispatch size as the simulation, so it is specialized
+            // with the same workgroup size.
+            const auto initShaderModule = m_engine->createShaderModule(
+                this->getShaderCode(shaders_glsl::shaderKey("shader_init.comp.glsl")),
+                ShaderCodeLifetime::Static
+            );
+            const auto initPipeline = this->buildComputePipeline(initPipelineLayout, initShaderModule, m_computeWorkgroupSize);
+
+            m_engine->releaseShaderModule(initShaderModule);
+
+            const auto descriptorSetAllocInfo = VkDescriptorSetAllocateInfo {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = m_descriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &initDescriptorSetLayout,
+            };
+
+            auto initDescriptorSet = VkDescriptorSet {};
+            const auto resultAllocateDescriptorSets = vkAllocateDescriptorSets(m_engine->getLogicalDevice(), &descriptorSetAllocInfo, &initDescriptorSet);
+            if (resultAllocateDescriptorSets != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate init descriptor set!");
+            }
+
+            const auto bufferSize = this->getParticleStorageBufferSize();
+            const auto storageBufferInfo = VkDescriptorBufferInfo {
+                .buffer = m_shaderStorageBuffers[0],
+                .offset = 0,
+                .range = bufferSize,
+            };
+            const auto descriptorWrite = VkWriteDescriptorSet {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = initDescriptorSet,
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo = &storageBufferInfo,
+            };
+            vkUpdateDescriptorSets(m_engine->getLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
+
+            // The init pass runs on the compute queue like every other simulation step.
+            const auto commandBufferAllocInfo = VkCommandBufferAllocateInfo {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = m_engine->getComputeCommandPool(),
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+
+            auto commandBuffer = VkCommandBuffer {};
+            const auto resultAllocateCommandBuffers = vkAllocateCommandBuffers(m_engine->getLogicalDevice(), &commandBufferAllocInfo, &commandBuffer);
+            if (resultAllocateCommandBuffers != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate init command buffer!");
+            }
+
+            const auto beginInfo = VkCommandBufferBeginInfo {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            };
+
+            const auto resultBeginCommandBuffer = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            if (resultBeginCommandBuffer != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording init command buffer!");
+            }
+
+            const uint64_t seed = m_particleSeed;
+            const auto pushConstants = InitShaderPushConstants {
+                .seedLow = static_cast<uint32_t>(seed),
+                .seedHigh = static_cast<uint32_t>(seed >> 32),
+                .particleCount = m_settings.particleCount,
+                .groupCountX = m_computeGroupCountX,
+                .aspectRatio = this->getAspectRatio(),
+            };
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, initPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, initPipelineLayout, 0, 1, &initDescriptorSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, initPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(InitShaderPushConstants), &pushConstants);
+            vkCmdDispatch(commandBuffer, m_computeGroupCountX, m_computeGroupCountY, 1);
+
+            // The copies into the other frames' buffers read what the init shader wrote.
+            const auto initBarrier = VkMemoryBarrier {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            };
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                1, &initBarrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            const auto copyRegion = VkBufferCopy {
+                .size = bufferSize,
+            };
+            for (size_t i = 1; i < m_shaderStorageBuffers.size(); i++) {
+                vkCmdCopyBuffer(commandBuffer, m_shaderStorageBuffers[0], m_shaderStorageBuffers[i], 1, &copyRegion);
+            }
+
+            // Every buffer is read by the simulation step afterwards. A compute queue cannot wait on the vertex
+            // input stage, so the draws are ordered after the init pass by waiting for the queue below instead.
+            const auto copyBarrier = VkMemoryBarrier {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            };
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &copyBarrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            const auto resultEndCommandBuffer = vkEndCommandBuffer(commandBuffer);
+            if (resultEndCommandBuffer != VK_SUCCESS) {
+                throw std::runtime_error("failed to record init command buffer!");
             }
 
-            m_computePipelineLayout = computePipelineLayout;
-            m_computePipeline = computePipeline;
-        }
+            const auto submitInfo = VkSubmitInfo {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &commandBuffer,
+            };
 
+            const auto resultQueueSubmit = vkQueueSubmit(m_engine->getComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+            if (resultQueueSubmit != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit init command buffer!");
+            }
 
+            const auto resultQueueWaitIdle = vkQueueWaitIdle(m_engine->getComputeQueue());
+            if (resultQueueWaitIdle != VK_SUCCESS) {
+                throw std::runtime_error("failed to wait for the init pass to finish!");
+            }
 
+            vkFreeCommandBuffers(m_engine->getLogicalDevice(), m_engine->getComputeCommandPool(), 1, &commandBuffer);
 
-        void _createShaderStorageBuffer(VkDeviceSize bufferSize, VkBuffer& storageBuffer, VkDeviceMemory& storageBufferMemory) {
-            const VkBufferUsageFlags usageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-            const VkMemoryPropertyFlags propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-            this->createBuffer(
-                bufferSize,
-                usageFlags,
-                propertyFlags,
-                storageBuffer,
-                storageBufferMemory
-            );
+            // The descriptor set goes back to the pool with everything else when the pool is destroyed.
+            vkDestroyPipeline(m_engine->getLogicalDevice(), initPipeline, nullptr);
+            vkDestroyPipelineLayout(m_engine->getLogicalDevice(), initPipelineLayout, nullptr);
+            vkDestroyDescriptorSetLayout(m_engine->getLogicalDevice(), initDescriptorSetLayout, nullptr);
         }
 
-        void _createShaderStorageBuffers(VkDeviceSize bufferSize) {
-            auto shaderStorageBuffers = std::vector<VkBuffer> { MAX_FRAMES_IN_FLIGHT };
-            auto shaderStorageBuffersMemory = std::vector<VkDeviceMemory> { MAX_FRAMES_IN_FLIGHT };
-
-            for (size_t i = 0; i < shaderStorageBuffers.size(); i++) {
-                this->_createShaderStorageBuffer(bufferSize, shaderStorageBuffers[i], shaderStorageBuffersMemory[i]);
+        void createShaderStorageBuffersMapped() {
+            // Host visible memory stays mapped for as long as it is allocated.
+            auto shaderStorageBuffersMapped = std::vector<void*> { m_shaderStorageBuffersMemory.size(), nullptr };
+            for (size_t i = 0; i < shaderStorageBuffersMapped.size(); i++) {
+                shaderStorageBuffersMapped[i] = m_shaderStorageBuffersMemory[i].mappedData;
             }
 
-            m_shaderStorageBuffers = std::move(shaderStorageBuffers);
-            m_shaderStorageBuffersMemory = std::move(shaderStorageBuffersMemory);
+            m_shaderStorageBuffersMapped = std::move(shaderStorageBuffersMapped);
         }
 
-        void _uploadShaderStorageBuffers(const std::vector<VkBuffer>& shaderStorageBuffers, const std::vector<Particle>& particles) {
-            const auto bufferSize = VkDeviceSize { sizeof(Particle) * particles.size() };
+        void createCpuSimulation(const std::vector<Particle>& particles) {
+            auto cpuSimulation = std::make_unique<CpuParticleSimulation>(particles, this->getFrameSlotCount(), m_settings.threadCount);
 
-            // Create a staging buffer used to upload data to the gpu
-            auto stagingBuffer = VkBuffer {};
-            auto stagingBufferMemory = VkDeviceMemory {};
-            this->createBuffer(
-                bufferSize,
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                stagingBuffer,
-                stagingBufferMemory
+            fmt::println(
+                "Simulating particles on the CPU with {} threads using the `{}` integrator",
+                cpuSimulation->getThreadCount(),
+                ParticleIntegrator::simdLevelToString(cpuSimulation->getSimdLevel())
             );
 
-            void* data;
-            vkMapMemory(m_engine->getLogicalDevice(), stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, particles.data(), static_cast<size_t>(bufferSize));
-            vkUnmapMemory(m_engine->getLogicalDevice(), stagingBufferMemory);
-
-            for (size_t i = 0; i < shaderStorageBuffers.size(); i++) {
-                this->copyBuffer(stagingBuffer, shaderStorageBuffers[i], bufferSize);
-            }
-
-            vkDestroyBuffer(m_engine->getLogicalDevice(), stagingBuffer, nullptr);
-            vkFreeMemory(m_engine->getLogicalDevice(), stagingBufferMemory, nullptr);
+            m_cpuSimulation = std::move(cpuSimulation);
         }
 
-        void createShaderStorageBuffers() {
-            auto initialState = ParticleGeneratorState {};
-            auto particleGenerator = ParticleGenerator { initialState };
-            auto particles = std::vector<Particle> { PARTICLE_COUNT };
-            particleGenerator.generate(particles);
+        void createShaderStorageBuffersSoA() {
+            const auto particleGenerator = this->createParticleGenerator();
+            auto threadPool = ThreadPool { m_settings.threadCount };
+            auto particles = ParticleArrays { m_settings.particleCount };
+            particleGenerator.generate(particles, threadPool);
+
+            const auto bufferSize = this->getParticleStorageBufferSize();
+            this->_createShaderStorageBuffers(bufferSize, m_positionStorageBuffers, m_positionStorageBuffersMemory);
+            this->_createShaderStorageBuffers(bufferSize, m_velocityStorageBuffers, m_velocityStorageBuffersMemory);
+            this->_uploadShaderStorageBuffers(m_positionStorageBuffers, particles.positions);
+            this->_uploadShaderStorageBuffers(m_velocityStorageBuffers, particles.velocities);
+
+            // The colors never change, so a single vertex buffer shared by every frame suffices.
+            auto colorBuffer = VkBuffer {};
+            auto colorBufferMemory = MemoryAllocation {};
+            this->createBuffer(
+                VkDeviceSize { sizeof(glm::vec4) * m_settings.particleCount },
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                this->getSharedBufferQueueFamilies(),
+                colorBuffer,
+                colorBufferMemory
+            );
 
-            this->_createShaderStorageBuffers(sizeof(Particle) * PARTICLE_COUNT);
-            this->_uploadShaderStorageBuffers(m_shaderStorageBuffers, particles);
+            m_colorBuffer = colorBuffer;
+            m_colorBufferMemory = colorBufferMemory;
+
+            this->_uploadShaderStorageBuffers(std::vector<VkBuffer> { m_colorBuffer }, particles.colors);
         }
     
-        void createUniformBuffer(VkDeviceSize bufferSize, VkBuffer& uniformBuffer, VkDeviceMemory& uniformBufferMemory, void*& uniformBufferMapped) {
+        void createUniformBuffer(VkDeviceSize bufferSize, VkBuffer& uniformBuffer, MemoryAllocation& uniformBufferMemory, void*& uniformBufferMapped) {
             const VkBufferUsageFlags usageFlags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
             const VkMemoryPropertyFlags propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
             this->createBuffer(
@@ -902,13 +2410,13 @@ class App final {
                 uniformBufferMemory
             );
             
-            vkMapMemory(m_engine->getLogicalDevice(), uniformBufferMemory, 0, bufferSize, 0, &uniformBufferMapped);
+            uniformBufferMapped = uniformBufferMemory.mappedData;
         }
 
         void createUniformBuffers(VkDeviceSize bufferSize) {
-            auto uniformBuffers = std::vector<VkBuffer> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            auto uniformBuffersMemory = std::vector<VkDeviceMemory> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            auto uniformBuffersMapped = std::vector<void*> { MAX_FRAMES_IN_FLIGHT, nullptr };
+            auto uniformBuffers = std::vector<VkBuffer> { this->getFrameSlotCount(), VK_NULL_HANDLE };
+            auto uniformBuffersMemory = std::vector<MemoryAllocation> { this->getFrameSlotCount() };
+            auto uniformBuffersMapped = std::vector<void*> { this->getFrameSlotCount(), nullptr };
 
             for (size_t i = 0; i < uniformBuffers.size(); i++) {
                 this->createUniformBuffer(
@@ -929,21 +2437,23 @@ class App final {
         }
 
         void createDescriptorPool() {
-            const auto poolSizes = std::array<VkDescriptorPoolSize, 2> {
-                VkDescriptorPoolSize {
-                    .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
-                },
-                VkDescriptorPoolSize {
-                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 2,
-                }
-            };
+            // Substeps take three more sets per frame slot.
+            const uint32_t computeSetCount = this->getFrameSlotCount() * (this->hasScratchParticleBuffer() ? 4 : 1);
+            auto poolSizes = this->getComputeShaderReflection().getDescriptorPoolSizes(0, computeSetCount);
+
+            // The init pass allocates one more set out of the same pool. A pool adds up the counts of pool sizes
+            // of the same type, so they do not need merging.
+            const uint32_t initSetCount = (m_settings.particleInit == ParticleInit::Gpu) ? 1 : 0;
+            if (initSetCount > 0) {
+                const auto initPoolSizes = this->getInitShaderReflection().getDescriptorPoolSizes(0, initSetCount);
+                poolSizes.insert(poolSizes.end(), initPoolSizes.begin(), initPoolSizes.end());
+            }
+
             const auto poolInfo = VkDescriptorPoolCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                .poolSizeCount = 2,
+                .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
                 .pPoolSizes = poolSizes.data(),
-                .maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+                .maxSets = computeSetCount + initSetCount,
             };
 
             auto descriptorPool = VkDescriptorPool {};
@@ -956,93 +2466,193 @@ class App final {
         }
 
         void createComputeDescriptorSets() {
-            const auto layouts = std::vector<VkDescriptorSetLayout> { MAX_FRAMES_IN_FLIGHT, m_computeDescriptorSetLayout };
+            auto computeDescriptorSets = this->allocateComputeDescriptorSets(this->getFrameSlotCount());
+            for (uint32_t i = 0; i < this->getFrameSlotCount(); i++) {
+                this->updateComputeDescriptorSet(computeDescriptorSets[i], i, this->getPreviousFrameSlot(i), i);
+            }
+
+            auto substepDescriptorSets = std::vector<SubstepDescriptorSets> {};
+            if (this->hasScratchParticleBuffer()) {
+                const uint32_t scratchBuffer = this->getScratchParticleBuffer();
+                const auto descriptorSets = this->allocateComputeDescriptorSets(3 * this->getFrameSlotCount());
+                for (uint32_t i = 0; i < this->getFrameSlotCount(); i++) {
+                    const auto substepSets = SubstepDescriptorSets {
+                        .previousToScratch = descriptorSets[3 * i],
+                        .currentToScratch = descriptorSets[3 * i + 1],
+                        .scratchToCurrent = descriptorSets[3 * i + 2],
+                    };
+                    this->updateComputeDescriptorSet(substepSets.previousToScratch, i, this->getPreviousFrameSlot(i), scratchBuffer);
+                    this->updateComputeDescriptorSet(substepSets.currentToScratch, i, i, scratchBuffer);
+                    this->updateComputeDescriptorSet(substepSets.scratchToCurrent, i, scratchBuffer, i);
+
+                    substepDescriptorSets.push_back(substepSets);
+                }
+            }
+
+            m_computeDescriptorSets = computeDescriptorSets;
+            m_substepDescriptorSets = substepDescriptorSets;
+        }
+
+        std::vector<VkDescriptorSet> allocateComputeDescriptorSets(uint32_t count) {
+            const auto layouts = std::vector<VkDescriptorSetLayout> { count, m_computeDescriptorSetLayout };
             const auto allocInfo = VkDescriptorSetAllocateInfo {
                 .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
                 .descriptorPool = m_descriptorPool,
-                .descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+                .descriptorSetCount = count,
                 .pSetLayouts = layouts.data(),
             };
 
-            auto computeDescriptorSets = std::vector<VkDescriptorSet> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            const auto result = vkAllocateDescriptorSets(m_engine->getLogicalDevice(), &allocInfo, computeDescriptorSets.data());
+            auto descriptorSets = std::vector<VkDescriptorSet> { count, VK_NULL_HANDLE };
+            const auto result = vkAllocateDescriptorSets(m_engine->getLogicalDevice(), &allocInfo, descriptorSets.data());
             if (result != VK_SUCCESS) {
                 throw std::runtime_error("failed to allocate descriptor sets!");
             }
 
-            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-                const auto uniformBufferInfo = VkDescriptorBufferInfo {
-                    .buffer = m_uniformBuffers[i],
-                    .offset = 0,
-                    .range = sizeof(ComputeShaderUniformBufferObject),
-                };
-                const auto storageBufferInfoLastFrame = VkDescriptorBufferInfo {
-                    .buffer = m_shaderStorageBuffers[(i - 1) % MAX_FRAMES_IN_FLIGHT],
-                    .offset = 0,
-                    .range = sizeof(Particle) * PARTICLE_COUNT,
-                };
-                const auto storageBufferInfoCurrentFrame = VkDescriptorBufferInfo {
-                    .buffer = m_shaderStorageBuffers[i],
-                    .offset = 0,
-                    .range = sizeof(Particle) * PARTICLE_COUNT,
-                };
-                const auto descriptorWrites = std::array<VkWriteDescriptorSet, 3> {
-                    VkWriteDescriptorSet {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = computeDescriptorSets[i],
-                        .dstBinding = 0,
-                        .dstArrayElement = 0,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                        .descriptorCount = 1,
-                        .pBufferInfo = &uniformBufferInfo,
-                    },
-                    VkWriteDescriptorSet {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = computeDescriptorSets[i],
-                        .dstBinding = 1,
-                        .dstArrayElement = 0,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .descriptorCount = 1,
-                        .pBufferInfo = &storageBufferInfoLastFrame,
-                    },
-                    VkWriteDescriptorSet {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .dstSet = computeDescriptorSets[i],
-                        .dstBinding = 2,
-                        .dstArrayElement = 0,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                        .descriptorCount = 1,
-                        .pBufferInfo = &storageBufferInfoCurrentFrame,
-                    }
-                };
+            return descriptorSets;
+        }
 
-                vkUpdateDescriptorSets(m_engine->getLogicalDevice(), 3, descriptorWrites.data(), 0, nullptr);
+        // Binds the uniform buffer of the frame slot, and the particle buffers with the given indices as the 
+        // input and output of the step.
+        void updateComputeDescriptorSet(VkDescriptorSet computeDescriptorSet, uint32_t frameSlot, uint32_t inputBuffer, uint32_t outputBuffer) {
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                this->updateComputeDescriptorSetSoA(computeDescriptorSet, frameSlot, inputBuffer, outputBuffer);
+            } else {
+                this->updateComputeDescriptorSetAoS(computeDescriptorSet, frameSlot, inputBuffer, outputBuffer);
             }
-
-            m_computeDescriptorSets = computeDescriptorSets;
         }
 
+        void updateComputeDescriptorSetAoS(VkDescriptorSet computeDescriptorSet, uint32_t frameSlot, uint32_t inputBuffer, uint32_t outputBuffer) {
+            const auto uniformBufferInfo = VkDescriptorBufferInfo {
+                .buffer = m_uniformBuffers[frameSlot],
+                .offset = 0,
+                .range = sizeof(ComputeShaderUniformBufferObject),
+            };
+            const auto storageBufferInfoLastFrame = VkDescriptorBufferInfo {
+                .buffer = m_shaderStorageBuffers[inputBuffer],
+                .offset = 0,
+                .range = this->getParticleStorageBufferSize(),
+            };
+            const auto storageBufferInfoCurrentFrame = VkDescriptorBufferInfo {
+                .buffer = m_shaderStorageBuffers[outputBuffer],
+                .offset = 0,
+                .range = this->getParticleStorageBufferSize(),
+            };
+            const auto descriptorWrites = std::array<VkWriteDescriptorSet, 3> {
+                VkWriteDescriptorSet {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = computeDescriptorSet,
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo = &uniformBufferInfo,
+                },
+                VkWriteDescriptorSet {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = computeDescriptorSet,
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo = &storageBufferInfoLastFrame,
+                },
+                VkWriteDescriptorSet {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = computeDescriptorSet,
+                    .dstBinding = 2,
+                    .dstArrayElement = 0,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo = &storageBufferInfoCurrentFrame,
+                }
+            };
 
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-            auto memProperties = VkPhysicalDeviceMemoryProperties {};
-            vkGetPhysicalDeviceMemoryProperties(m_engine->getPhysicalDevice(), &memProperties);
+            vkUpdateDescriptorSets(m_engine->getLogicalDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
 
-            for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-                if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                    return i;
+        void updateComputeDescriptorSetSoA(VkDescriptorSet computeDescriptorSet, uint32_t frameSlot, uint32_t inputBuffer, uint32_t outputBuffer) {
+            const auto uniformBufferInfo = VkDescriptorBufferInfo {
+                .buffer = m_uniformBuffers[frameSlot],
+                .offset = 0,
+                .range = sizeof(ComputeShaderUniformBufferObject),
+            };
+            const auto storageBufferInfos = std::array<VkDescriptorBufferInfo, 4> {
+                VkDescriptorBufferInfo {
+                    .buffer = m_positionStorageBuffers[inputBuffer],
+                    .offset = 0,
+                    .range = this->getParticleStorageBufferSize(),
+                },
+                VkDescriptorBufferInfo {
+                    .buffer = m_velocityStorageBuffers[inputBuffer],
+                    .offset = 0,
+                    .range = this->getParticleStorageBufferSize(),
+                },
+                VkDescriptorBufferInfo {
+                    .buffer = m_positionStorageBuffers[outputBuffer],
+                    .offset = 0,
+                    .range = this->getParticleStorageBufferSize(),
+                },
+                VkDescriptorBufferInfo {
+                    .buffer = m_velocityStorageBuffers[outputBuffer],
+                    .offset = 0,
+                    .range = this->getParticleStorageBufferSize(),
                 }
+            };
+
+            auto descriptorWrites = std::array<VkWriteDescriptorSet, 5> {};
+            descriptorWrites[0] = VkWriteDescriptorSet {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = computeDescriptorSet,
+                .dstBinding = 0,
+                .dstArrayElement = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .descriptorCount = 1,
+                .pBufferInfo = &uniformBufferInfo,
+            };
+            for (uint32_t binding = 1; binding < descriptorWrites.size(); binding++) {
+                descriptorWrites[binding] = VkWriteDescriptorSet {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = computeDescriptorSet,
+                    .dstBinding = binding,
+                    .dstArrayElement = 0,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo = &storageBufferInfos[binding - 1],
+                };
             }
 
-            throw std::runtime_error("failed to find suitable memory type!");
+            vkUpdateDescriptorSets(m_engine->getLogicalDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
         }
 
 
-        void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+        void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory) {
+            this->createBuffer(size, usage, properties, std::vector<uint32_t> {}, buffer, bufferMemory);
+        }
+
+        // A buffer used by more than one queue family is shared concurrently between them, so that it never
+        // needs a queue family ownership transfer.
+        void createBuffer(
+            VkDeviceSize size,
+            VkBufferUsageFlags usage,
+            VkMemoryPropertyFlags properties,
+            const std::vector<uint32_t>& queueFamilyIndices,
+            VkBuffer& buffer,
+            MemoryAllocation& bufferMemory
+        ) {
+            const auto sharingMode = [&queueFamilyIndices]() -> VkSharingMode {
+                if (queueFamilyIndices.size() > 1) {
+                    return VK_SHARING_MODE_CONCURRENT;
+                } else {
+                    return VK_SHARING_MODE_EXCLUSIVE;
+                }
+            }();
             const auto bufferInfo = VkBufferCreateInfo {
                 .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
                 .size = size,
                 .usage = usage,
-                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .sharingMode = sharingMode,
+                .queueFamilyIndexCount = (sharingMode == VK_SHARING_MODE_CONCURRENT) ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0,
+                .pQueueFamilyIndices = (sharingMode == VK_SHARING_MODE_CONCURRENT) ? queueFamilyIndices.data() : nullptr,
             };
 
             const auto resultCreateBuffer = vkCreateBuffer(m_engine->getLogicalDevice(), &bufferInfo, nullptr, &buffer);
@@ -1053,27 +2663,20 @@ class App final {
             auto memRequirements = VkMemoryRequirements {};
             vkGetBufferMemoryRequirements(m_engine->getLogicalDevice(), buffer, &memRequirements);
 
-            const auto allocInfo = VkMemoryAllocateInfo {
-                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .allocationSize = memRequirements.size,
-                .memoryTypeIndex = this->findMemoryType(memRequirements.memoryTypeBits, properties),
-            };
-
-            const auto resultAllocateMemory = vkAllocateMemory(m_engine->getLogicalDevice(), &allocInfo, nullptr, &bufferMemory);
-            if (resultAllocateMemory != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate buffer memory!");
-            }
+            // The engine suballocates buffers out of large blocks of device memory.
+            bufferMemory = m_engine->allocateMemory(memRequirements, properties);
 
-            vkBindBufferMemory(m_engine->getLogicalDevice(), buffer, bufferMemory, 0);
+            vkBindBufferMemory(m_engine->getLogicalDevice(), buffer, bufferMemory.memory, bufferMemory.offset);
         }
 
 
 
+        // Runs on the transfer queue, so a readback only waits for other copies and never for rendering.
         void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
             const auto allocInfo = VkCommandBufferAllocateInfo {
                 .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
                 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-                .commandPool = m_engine->getCommandPool(),
+                .commandPool = m_engine->getTransferCommandPool(),
                 .commandBufferCount = 1,
             };
 
@@ -1100,49 +2703,38 @@ class App final {
                 .pCommandBuffers = &commandBuffer,
             };
 
-            vkQueueSubmit(m_engine->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(m_engine->getGraphicsQueue());
+            vkQueueSubmit(m_engine->getTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+            vkQueueWaitIdle(m_engine->getTransferQueue());
 
-            vkFreeCommandBuffers(m_engine->getLogicalDevice(), m_engine->getCommandPool(), 1, &commandBuffer);
+            vkFreeCommandBuffers(m_engine->getLogicalDevice(), m_engine->getTransferCommandPool(), 1, &commandBuffer);
         }
 
         void createCommandBuffers() {
-            auto commandBuffers = std::vector<VkCommandBuffer> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-
-            const auto allocInfo = VkCommandBufferAllocateInfo {
-                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-                .commandPool = m_engine->getCommandPool(),
-                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-                .commandBufferCount = static_cast<uint32_t>(commandBuffers.size()),
-            };
-
-            const auto result = vkAllocateCommandBuffers(m_engine->getLogicalDevice(), &allocInfo, commandBuffers.data());
-            if (result != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate command buffers!");
-            }
+            // A draw only differs in its frame slot and the swap chain image it renders into.
+            auto commandBuffers = std::make_unique<CommandBufferCache>(
+                *m_engine,
+                m_engine->getCommandPool(),
+                this->getFrameSlotCount(),
+                static_cast<uint32_t>(m_swapChainImages.size())
+            );
 
             m_commandBuffers = std::move(commandBuffers);
         }
 
         void createComputeCommandBuffers() {
-            auto computeCommandBuffers = std::vector<VkCommandBuffer> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-
-            const auto allocInfo = VkCommandBufferAllocateInfo {
-                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-                .commandPool = m_engine->getCommandPool(),
-                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-                .commandBufferCount = static_cast<uint32_t>(computeCommandBuffers.size()),
-            };
-
-            const auto result = vkAllocateCommandBuffers(m_engine->getLogicalDevice(), &allocInfo, computeCommandBuffers.data());
-            if (result != VK_SUCCESS) {
-                throw std::runtime_error("failed to allocate compute command buffers!");
-            }
+            // The time step reaches the shader through the uniform buffer, so a step only differs in its frame slot
+            // and the number of substeps it runs.
+            auto computeCommandBuffers = std::make_unique<CommandBufferCache>(
+                *m_engine,
+                m_engine->getComputeCommandPool(),
+                this->getFrameSlotCount(),
+                this->getMaxSubstepCount() + 1
+            );
 
             m_computeCommandBuffers = std::move(computeCommandBuffers);
         }
 
-        void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) {
             const auto beginInfo = VkCommandBufferBeginInfo {
                 .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
             };
@@ -1164,6 +2756,10 @@ class App final {
                 .pClearValues = &clearColor,
             };
 
+            if (m_gpuProfiler) {
+                m_gpuProfiler->recordBegin(commandBuffer, frameIndex, RENDER_PASS_PROFILER_SCOPE);
+            }
+
             vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
             vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
@@ -1184,20 +2780,30 @@ class App final {
             };
             vkCmdSetScissor(commandBuffer, 0, 1, &scissor);            
 
-            const auto offsets = std::array<VkDeviceSize, 1> { 0 };
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_shaderStorageBuffers[m_currentFrame], offsets.data());
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                const auto vertexBuffers = std::array<VkBuffer, 2> { m_positionStorageBuffers[frameIndex], m_colorBuffer };
+                const auto offsets = std::array<VkDeviceSize, 2> { 0, 0 };
+                vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(vertexBuffers.size()), vertexBuffers.data(), offsets.data());
+            } else {
+                const auto offsets = std::array<VkDeviceSize, 1> { 0 };
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_shaderStorageBuffers[frameIndex], offsets.data());
+            }
 
-            vkCmdDraw(commandBuffer, PARTICLE_COUNT, 1, 0, 0);
+            vkCmdDraw(commandBuffer, m_settings.particleCount, 1, 0, 0);
 
             vkCmdEndRenderPass(commandBuffer);
 
+            if (m_gpuProfiler) {
+                m_gpuProfiler->recordEnd(commandBuffer, frameIndex, RENDER_PASS_PROFILER_SCOPE);
+            }
+
             const auto resultEndCommandBuffer = vkEndCommandBuffer(commandBuffer);
             if (resultEndCommandBuffer != VK_SUCCESS) {
                 throw std::runtime_error("failed to record command buffer!");
             }
         }
 
-        void recordComputeCommandBuffer(VkCommandBuffer commandBuffer) {
+        void recordComputeCommandBuffer(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t substepCount) {
             const auto beginInfo = VkCommandBufferBeginInfo {
                 .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
             };
@@ -1207,20 +2813,37 @@ class App final {
                 throw std::runtime_error("failed to begin recording compute command buffer!");
             }
 
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
-
-            vkCmdBindDescriptorSets(
+            // The step reads the particles the previous step on this queue wrote, and may overwrite the scratch 
+            // buffer it used.
+            const auto previousStepBarrier = VkMemoryBarrier {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+            };
+            vkCmdPipelineBarrier(
                 commandBuffer,
-                VK_PIPELINE_BIND_POINT_COMPUTE,
-                m_computePipelineLayout,
-                0,
-                1,
-                &m_computeDescriptorSets[m_currentFrame],
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
                 0,
-                nullptr
+                1, &previousStepBarrier,
+                0, nullptr,
+                0, nullptr
             );
 
-            vkCmdDispatch(commandBuffer, PARTICLE_COUNT / 256, 1, 1);
+            // A step without a substep is timed as well, so every submitted step has a result to read back.
+            if (m_gpuProfiler) {
+                m_gpuProfiler->recordBegin(commandBuffer, frameIndex, COMPUTE_PROFILER_SCOPE);
+            }
+
+            if (substepCount == 0) {
+                this->recordParticleCopy(commandBuffer, this->getPreviousFrameSlot(frameIndex), frameIndex);
+            } else {
+                this->recordSubsteps(commandBuffer, frameIndex, substepCount);
+            }
+
+            if (m_gpuProfiler) {
+                m_gpuProfiler->recordEnd(commandBuffer, frameIndex, COMPUTE_PROFILER_SCOPE);
+            }
 
             const auto resultEndCommandBuffer = vkEndCommandBuffer(commandBuffer);
             if (resultEndCommandBuffer != VK_SUCCESS) {
@@ -1228,134 +2851,345 @@ class App final {
             }
         }
 
-        void createComputeSyncObjects() {
-            auto computeFinishedSemaphores = std::vector<VkSemaphore> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
-            auto computeInFlightFences = std::vector<VkFence> { MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE };
+        void recordSubsteps(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t substepCount) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+
+            const auto descriptorSets = this->getSubstepDescriptorSets(frameIndex, substepCount);
+            for (size_t substep = 0; substep < descriptorSets.size(); substep++) {
+                if (substep > 0) {
+                    // Each substep reads what the one before it wrote, and overwrites what the one before that read.
+                    const auto substepBarrier = VkMemoryBarrier {
+                        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    };
+                    vkCmdPipelineBarrier(
+                        commandBuffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        1, &substepBarrier,
+                        0, nullptr,
+                        0, nullptr
+                    );
+                }
+
+                vkCmdBindDescriptorSets(
+                    commandBuffer,
+                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                    m_computePipelineLayout,
+                    0,
+                    1,
+                    &descriptorSets[substep],
+                    0,
+                    nullptr
+                );
+
+                vkCmdDispatch(commandBuffer, m_computeGroupCountX, m_computeGroupCountY, 1);
+            }
+        }
+
+        // The substeps alternate between the frame's buffer and the scratch buffer, starting out in whichever one 
+        // makes the last substep write the frame's buffer.
+        std::vector<VkDescriptorSet> getSubstepDescriptorSets(uint32_t frameIndex, uint32_t substepCount) const {
+            auto descriptorSets = std::vector<VkDescriptorSet> {};
+            if (substepCount % 2 == 1) {
+                descriptorSets.push_back(m_computeDescriptorSets[frameIndex]);
+            } else {
+                descriptorSets.push_back(m_substepDescriptorSets[frameIndex].previousToScratch);
+                descriptorSets.push_back(m_substepDescriptorSets[frameIndex].scratchToCurrent);
+            }
+
+            while (descriptorSets.size() < substepCount) {
+                descriptorSets.push_back(m_substepDescriptorSets[frameIndex].currentToScratch);
+                descriptorSets.push_back(m_substepDescriptorSets[frameIndex].scratchToCurrent);
+            }
+
+            return descriptorSets;
+        }
 
-            const auto semaphoreInfo = VkSemaphoreCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        // A frame without a substep still draws from its own buffer, so the particles are carried over unchanged.
+        void recordParticleCopy(VkCommandBuffer commandBuffer, uint32_t srcBuffer, uint32_t dstBuffer) {
+            const auto copyRegion = VkBufferCopy {
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = this->getParticleStorageBufferSize(),
             };
-            const auto fenceInfo = VkFenceCreateInfo {
-                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-                .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+
+            if (m_settings.particleLayout == ParticleLayout::StructureOfArrays) {
+                vkCmdCopyBuffer(commandBuffer, m_positionStorageBuffers[srcBuffer], m_positionStorageBuffers[dstBuffer], 1, &copyRegion);
+                vkCmdCopyBuffer(commandBuffer, m_velocityStorageBuffers[srcBuffer], m_velocityStorageBuffers[dstBuffer], 1, &copyRegion);
+            } else {
+                vkCmdCopyBuffer(commandBuffer, m_shaderStorageBuffers[srcBuffer], m_shaderStorageBuffers[dstBuffer], 1, &copyRegion);
+            }
+        }
+
+        void createFrameScheduler() {
+            auto frameScheduler = std::make_unique<FrameScheduler>(
+                *m_engine,
+                this->getFrameSlotCount(),
+                m_settings.framesInFlight,
+                m_settings.framePacing,
+                static_cast<double>(m_settings.targetFrameRate)
+            );
+
+            m_frameScheduler = std::move(frameScheduler);
+        }
+
+        void createGpuProfiler() {
+            if (!m_settings.profileGpu) {
+                return;
+            }
+
+            const auto& indices = m_engine->getQueueFamilyIndices();
+            auto scopes = std::vector<GpuProfilerScope> {
+                GpuProfilerScope { .name = "compute", .queueFamilyIndex = indices.getComputeFamily() },
+                GpuProfilerScope { .name = "render pass", .queueFamilyIndex = indices.graphicsAndComputeFamily.value() },
             };
 
-            for (size_t i = 0; i < computeFinishedSemaphores.size(); i++) {
-                const auto result = vkCreateSemaphore(m_engine->getLogicalDevice(), &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]);
-                if (result != VK_SUCCESS) {
-                    throw std::runtime_error("failed to create compute finished semaphore for a frame");
+            m_gpuProfiler = std::make_unique<GpuProfiler>(
+                *m_engine,
+                this->getFrameSlotCount(),
+                std::move(scopes),
+                GPU_PROFILER_WINDOW_SIZE,
+                m_settings.gpuTraceFile.has_value()
+            );
+
+            if (!m_gpuProfiler->isScopeSupported(COMPUTE_PROFILER_SCOPE)) {
+                fmt::println("The compute queue does not support timestamps, so compute is not profiled");
+            }
+
+            if (!m_engine->isHeadless() && !m_gpuProfiler->isScopeSupported(RENDER_PASS_PROFILER_SCOPE)) {
+                fmt::println("The graphics queue does not support timestamps, so the render pass is not profiled");
+            }
+        }
+
+        uint32_t getFrameSlotCount() const {
+            return std::max(m_settings.framesInFlight, MIN_FRAME_SLOT_COUNT);
+        }
+
+        uint32_t getPreviousFrameSlot(uint32_t frameSlot) const {
+            return (frameSlot + this->getFrameSlotCount() - 1) % this->getFrameSlotCount();
+        }
+
+        void beginFrame() {
+            if (m_frameScheduler) {
+                m_frameScheduler->beginFrame();
+            }
+
+            // Picks up the timings of the frames finished by now, a few frames after they were submitted.
+            if (m_gpuProfiler) {
+                m_gpuProfiler->collect();
+            }
+
+            this->applyReloadedPipelines();
+        }
+
+        // Swaps in the pipelines rebuilt since the last frame, without waiting for the device. The frames
+        // already submitted go on with the old pipelines, so those are only destroyed once the last of them
+        // has finished. The cached command buffers are recorded again with the new pipelines as their frame
+        // slots come up, and the particle buffers are left as they are, so the simulation carries on.
+        void applyReloadedPipelines() {
+            if (!m_shaderHotReloader) {
+                return;
+            }
+
+            std::erase_if(m_retiredPipelines, [this](const RetiredPipeline& retiredPipeline) {
+                if (!m_frameScheduler->isFrameFinished(retiredPipeline.lastFrameNumber)) {
+                    return false;
                 }
+
+                vkDestroyPipeline(m_engine->getLogicalDevice(), retiredPipeline.pipeline, nullptr);
+
+                return true;
+            });
+
+            auto reloadedPipelines = std::vector<ReloadedPipeline> {};
+            {
+                auto lock = std::unique_lock<std::mutex> { m_reloadedPipelinesMutex };
+                reloadedPipelines.swap(m_reloadedPipelines);
             }
 
-            for (size_t i = 0; i < computeInFlightFences.size(); i++) {
-                const auto result = vkCreateFence(m_engine->getLogicalDevice(), &fenceInfo, nullptr, &computeInFlightFences[i]);
-                if (result != VK_SUCCESS) {
-                    throw std::runtime_error("failed to create compute in flight fence for a frame");
+            const uint64_t lastSubmittedFrameNumber = m_frameScheduler->getFrameNumber() - 1;
+            for (const auto& reloadedPipeline : reloadedPipelines) {
+                const bool isGraphics = reloadedPipeline.bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS;
+                auto& currentPipeline = isGraphics ? m_graphicsPipeline : m_computePipeline;
+                m_retiredPipelines.push_back(RetiredPipeline {
+                    .pipeline = currentPipeline,
+                    .lastFrameNumber = lastSubmittedFrameNumber,
+                });
+
+                currentPipeline = reloadedPipeline.pipeline;
+                if (isGraphics) {
+                    m_commandBuffers->invalidate();
+                } else {
+                    m_computeCommandBuffers->invalidate();
                 }
             }
+        }
+
+        void advanceFrame() {
+            if (m_frameScheduler) {
+                m_frameScheduler->advance();
+            }
+
+            if (!m_hasReportedFirstFrame) {
+                this->printTimeToFirstFrame();
+                m_hasReportedFirstFrame = true;
+            }
+
+            m_currentFrame = (m_currentFrame + 1) % this->getFrameSlotCount();
+        }
+
+        uint32_t getMaxSubstepCount() const {
+            if (m_settings.simulationRate > 0) {
+                return m_settings.maxSubstepCount;
+            } else {
+                return 1;
+            }
+        }
+
+        float getSimulationTimeStep() const {
+            // A fixed time step keeps every substep the same length, no matter how long the frame took.
+            if (m_settings.simulationRate > 0) {
+                return (1000.0f / static_cast<float>(m_settings.simulationRate)) * 2.0f;
+            }
 
-            m_computeFinishedSemaphores = std::move(computeFinishedSemaphores);
-            m_computeInFlightFences = std::move(computeInFlightFences);
+            return m_lastFrameTime * 2.0f;
+        }
+
+        // Adds the last frame's time to the accumulator, and takes as many fixed time steps out of it as fit.
+        void advanceSimulationClock() {
+            if (m_settings.simulationRate == 0) {
+                m_substepCount = 1;
+                m_totalSubstepCount++;
+
+                return;
+            }
+
+            const double stepTime = 1000.0 / static_cast<double>(m_settings.simulationRate);
+            m_simulationTimeAccumulator += static_cast<double>(m_lastFrameTime);
+
+            const auto dueSubstepCount = static_cast<uint64_t>(std::floor(m_simulationTimeAccumulator / stepTime + SUBSTEP_EPSILON));
+            m_substepCount = static_cast<uint32_t>(std::min<uint64_t>(dueSubstepCount, m_settings.maxSubstepCount));
+            m_totalSubstepCount += m_substepCount;
+
+            if (dueSubstepCount > m_settings.maxSubstepCount) {
+                // Drop the time the simulation cannot catch up on, rather than falling further behind every frame.
+                m_simulationTimeAccumulator = 0.0;
+            } else {
+                m_simulationTimeAccumulator = std::max(m_simulationTimeAccumulator - static_cast<double>(m_substepCount) * stepTime, 0.0);
+            }
         }
 
         void updateUniformBuffer(uint32_t currentImage) {
             const auto ubo = ComputeShaderUniformBufferObject {
-                .deltaTime = m_lastFrameTime * 2.0f,
+                .deltaTime = this->getSimulationTimeStep(),
+                .particleCount = m_settings.particleCount,
+                .groupCountX = m_computeGroupCountX,
             };
 
             memcpy(m_uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
         }
 
-        void draw() {
-            // Compute submission        
-            vkWaitForFences(m_engine->getLogicalDevice(), 1, &m_computeInFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+        void submitCompute() {
+            // Only the uniform buffer of this frame is rewritten on the host, along with the command buffer the
+            // first time around. The step waits for the draw that last read its vertex buffer on the device.
+            m_frameScheduler->waitForComputeSlot();
 
             this->updateUniformBuffer(m_currentFrame);
 
-            vkResetFences(m_engine->getLogicalDevice(), 1, &m_computeInFlightFences[m_currentFrame]);
+            const auto commandBuffer = m_computeCommandBuffers->get(
+                m_currentFrame,
+                m_substepCount,
+                [this](VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t substepCount) {
+                    this->recordComputeCommandBuffer(commandBuffer, frameIndex, substepCount);
+                }
+            );
 
-            vkResetCommandBuffer(m_computeCommandBuffers[m_currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-            this->recordComputeCommandBuffer(m_computeCommandBuffers[m_currentFrame]);
+            if (m_gpuProfiler) {
+                m_gpuProfiler->markSubmitted(m_currentFrame, COMPUTE_PROFILER_SCOPE, m_frameScheduler->getFrameNumber());
+            }
 
-            const auto waitSempaphores = std::array<VkSemaphore, 0> {};
-            const auto computeSignalSemaphores = std::array<VkSemaphore, 1> { m_computeFinishedSemaphores[m_currentFrame] };
+            m_frameScheduler->submitCompute(commandBuffer);
+        }
 
-            const auto computeSubmitInfo = VkSubmitInfo {
-                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .commandBufferCount = 1,
-                .pCommandBuffers = &m_computeCommandBuffers[m_currentFrame],
-                .signalSemaphoreCount = computeSignalSemaphores.size(),
-                .pSignalSemaphores = computeSignalSemaphores.data(),
-            };
+        void stepCpuSimulation() {
+            // The step overwrites this frame's vertex buffer on the host, so the draw that last read it has to finish first.
+            if (m_frameScheduler) {
+                m_frameScheduler->waitForGraphicsSlot();
+            }
 
-            const auto resultQueueSubmitCompute = vkQueueSubmit(m_engine->getComputeQueue(), 1, &computeSubmitInfo, m_computeInFlightFences[m_currentFrame]);
-            if (resultQueueSubmitCompute != VK_SUCCESS) {
-                throw std::runtime_error("failed to submit compute command buffer!");
-            };
+            m_cpuSimulation->step(m_currentFrame, this->getSimulationTimeStep(), m_substepCount);
+
+            if (!m_shaderStorageBuffersMapped.empty()) {
+                const auto particles = m_cpuSimulation->getParticles(m_currentFrame);
+                memcpy(m_shaderStorageBuffersMapped[m_currentFrame], particles.data(), particles.size_bytes());
+            }
+
+            if (m_frameScheduler) {
+                m_frameScheduler->signalComputeFromHost();
+            }
+        }
+
+        void simulate() {
+            this->advanceSimulationClock();
+
+            if (m_settings.simulationBackend == SimulationBackend::Cpu) {
+                this->stepCpuSimulation();
+            } else {
+                this->submitCompute();
+            }
+        }
+
+        void draw() {
+            // Compute submission
+            this->simulate();
 
             // Graphics submission
-            vkWaitForFences(m_engine->getLogicalDevice(), 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+            m_frameScheduler->waitForGraphicsSlot();
 
             uint32_t imageIndex = 0;
             const auto resultAcquireNextImageKHR = vkAcquireNextImageKHR(
                 m_engine->getLogicalDevice(),
                 m_swapChain,
                 UINT64_MAX,
-                m_imageAvailableSemaphores[m_currentFrame],
+                m_frameScheduler->getImageAvailableSemaphore(),
                 VK_NULL_HANDLE,
                 &imageIndex
             );
         
             if (resultAcquireNextImageKHR == VK_ERROR_OUT_OF_DATE_KHR) {
+                // The step has already been submitted, so the frame still has to be retired on the graphics timeline.
+                m_frameScheduler->skipGraphics();
+                this->advanceFrame();
                 this->recreateSwapChain();
                 return;
             } else if (resultAcquireNextImageKHR != VK_SUCCESS && resultAcquireNextImageKHR != VK_SUBOPTIMAL_KHR) {
                 throw std::runtime_error("failed to acquire swap chain image!");
             }
 
-            vkResetFences(m_engine->getLogicalDevice(), 1, &m_inFlightFences[m_currentFrame]);
-
-            vkResetCommandBuffer(m_commandBuffers[m_currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-            this->recordCommandBuffer(m_commandBuffers[m_currentFrame], imageIndex);
-
-            const auto waitSemaphores = std::array<VkSemaphore, 2> { 
-                m_computeFinishedSemaphores[m_currentFrame],
-                m_imageAvailableSemaphores[m_currentFrame]
-            };
-            const auto waitStages = std::array<VkPipelineStageFlags, 2> { 
-                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-            };
-            const auto graphicsSignalSemaphores = std::array<VkSemaphore, 1> { m_renderFinishedSemaphores[m_currentFrame] };
-
-            const auto graphicsSubmitInfo = VkSubmitInfo {
-                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .waitSemaphoreCount = waitSemaphores.size(),
-                .pWaitSemaphores = waitSemaphores.data(),
-                .pWaitDstStageMask = waitStages.data(),
-                .commandBufferCount = 1,
-                .pCommandBuffers = &m_commandBuffers[m_currentFrame],
-                .signalSemaphoreCount = graphicsSignalSemaphores.size(),
-                .pSignalSemaphores = graphicsSignalSemaphores.data(),
-            };
-
-            const auto resultQueueSubmitGraphics = vkQueueSubmit(
-                m_engine->getGraphicsQueue(),
-                1,
-                &graphicsSubmitInfo,
-                m_inFlightFences[m_currentFrame]
+            const auto commandBuffer = m_commandBuffers->get(
+                m_currentFrame,
+                imageIndex,
+                [this](VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) {
+                    this->recordCommandBuffer(commandBuffer, frameIndex, imageIndex);
+                }
             );
-        
-            if (resultQueueSubmitGraphics != VK_SUCCESS) {
-                throw std::runtime_error("failed to submit draw command buffer!");
+
+            if (m_gpuProfiler) {
+                m_gpuProfiler->markSubmitted(m_currentFrame, RENDER_PASS_PROFILER_SCOPE, m_frameScheduler->getFrameNumber());
             }
 
+            m_frameScheduler->submitGraphics(commandBuffer);
+
+            const auto renderFinishedSemaphore = m_frameScheduler->getRenderFinishedSemaphore();
             const auto swapChains = std::array<VkSwapchainKHR, 1> { m_swapChain };
 
             const auto presentInfo = VkPresentInfoKHR {
                 .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
                 .waitSemaphoreCount = 1,
-                .pWaitSemaphores = &m_renderFinishedSemaphores[m_currentFrame],
+                .pWaitSemaphores = &renderFinishedSemaphore,
                 .swapchainCount = 1,
                 .pSwapchains = swapChains.data(),
                 .pImageIndices = &imageIndex,
@@ -1369,14 +3203,15 @@ class App final {
                 throw std::runtime_error("failed to present swap chain image!");
             }
 
-            m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+            this->advanceFrame();
         }
 };
 
-int main() {
-    auto app = App {};
-
+int main(int argc, char* argv[]) {
     try {
+        const auto settings = AppSettings::fromCommandLine(argc, argv);
+        auto app = App { settings };
+
         app.run();
     } catch (const std::exception& exception) {
         fmt::println(std::cerr, "{}", exception.what());
@@ -0,0 +1,200 @@
+#include "mapped_file.h"
+
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fmt/core.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using MappedFile = VulkanEngine::MappedFile;
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path& filePath)
+    : m_data { nullptr }
+    , m_size { 0 }
+{
+    const auto file = CreateFileW(
+        filePath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(fmt::format("failed to open file `{}`!", filePath.string()));
+    }
+
+    auto fileSize = LARGE_INTEGER {};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+
+        throw std::runtime_error(fmt::format("failed to get the size of file `{}`!", filePath.string()));
+    }
+
+    // An empty file cannot be mapped, and has nothing to map anyway.
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(file);
+
+        return;
+    }
+
+    const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        throw std::runtime_error(fmt::format("failed to map file `{}`!", filePath.string()));
+    }
+
+    // The view keeps the mapping alive on its own.
+    const auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        throw std::runtime_error(fmt::format("failed to map file `{}`!", filePath.string()));
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+}
+
+void MappedFile::unmap() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& filePath)
+    : m_data { nullptr }
+    , m_size { 0 }
+{
+    const int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        throw std::runtime_error(fmt::format("failed to open file `{}`!", filePath.string()));
+    }
+
+    struct stat fileStatus {};
+    if (fstat(file, &fileStatus) != 0) {
+        close(file);
+
+        throw std::runtime_error(fmt::format("failed to get the size of file `{}`!", filePath.string()));
+    }
+
+    // An empty file cannot be mapped, and has nothing to map anyway.
+    if (fileStatus.st_size == 0) {
+        close(file);
+
+        return;
+    }
+
+    const auto size = static_cast<size_t>(fileStatus.st_size);
+    const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive on its own.
+    close(file);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(fmt::format("failed to map file `{}`!", filePath.string()));
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = size;
+}
+
+void MappedFile::unmap() {
+    if (m_data != nullptr) {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    this->unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data { std::exchange(other.m_data, nullptr) }
+    , m_size { std::exchange(other.m_size, 0) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        this->unmap();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+std::span<const std::byte> MappedFile::getBytes() const {
+    return std::span<const std::byte> { m_data, m_size };
+}
+
+void VulkanEngine::writeFileAtomically(
+    const std::filesystem::path& filePath,
+    std::string_view fileDescription,
+    const std::function<void(std::ofstream&)>& write
+) {
+    if (filePath.has_parent_path()) {
+        std::filesystem::create_directories(filePath.parent_path());
+    }
+
+    // The temporary file lives in the same directory, so that the rename never crosses file systems, and
+    // has a name of its own, so that processes writing at the same time do not clobber each other's
+    // half-written data.
+    auto randomDevice = std::random_device {};
+    auto temporaryPath = filePath;
+    temporaryPath += fmt::format(".{:08x}{:08x}.tmp", randomDevice(), randomDevice());
+
+    {
+        auto file = std::ofstream { temporaryPath, std::ios::binary | std::ios::trunc };
+        if (!file.is_open()) {
+            throw std::runtime_error(fmt::format("failed to open {} `{}` for writing!", fileDescription, temporaryPath.string()));
+        }
+
+        write(file);
+
+        file.close();
+        if (!file) {
+            auto errorCode = std::error_code {};
+            std::filesystem::remove(temporaryPath, errorCode);
+
+            throw std::runtime_error(fmt::format("failed to write {} `{}`!", fileDescription, temporaryPath.string()));
+        }
+    }
+
+    auto errorCode = std::error_code {};
+    std::filesystem::rename(temporaryPath, filePath, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(temporaryPath, errorCode);
+
+        throw std::runtime_error(fmt::format("failed to replace {} `{}`!", fileDescription, filePath.string()));
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <string_view>
+
+
+namespace VulkanEngine {
+
+// A read-only view of a whole file, mapped into memory instead of read into a buffer, so that the
+// pages are only brought in when something reads them and are shared with the page cache instead
+// of copied. The mapping starts on a page boundary, so a view of it is aligned for any type the file
+// holds at a suitably aligned offset. The file is mapped privately, so changes other processes make
+// to it afterwards may or may not show through; replace files by renaming over them instead.
+class MappedFile final {
+    public:
+        explicit MappedFile(const std::filesystem::path& filePath);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::span<const std::byte> getBytes() const;
+    private:
+        const std::byte* m_data;
+        size_t m_size;
+
+        void unmap();
+};
+
+// Writes a whole file with `write` into a temporary file next to `filePath`, and renames it over `filePath`
+// once it is complete. A reader, including one that has the old file mapped, only ever sees a whole file,
+// and of several processes writing the file at the same time the last rename wins. `fileDescription` names
+// the file in errors, such as "shader archive".
+void writeFileAtomically(
+    const std::filesystem::path& filePath,
+    std::string_view fileDescription,
+    const std::function<void(std::ofstream&)>& write
+);
+
+}
+
+#endif // _MAPPED_FILE_H
@@ -0,0 +1,325 @@
+#include "memory_allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <stdexcept>
+
+
+using MemoryStats = VulkanEngine::MemoryStats;
+
+double MemoryStats::getExternalFragmentation() const {
+    if (freeBytes == 0) {
+        return 0.0;
+    }
+
+    return 1.0 - static_cast<double>(largestFreeRange) / static_cast<double>(freeBytes);
+}
+
+double MemoryStats::getInternalFragmentation() const {
+    if (usedBytes == 0) {
+        return 0.0;
+    }
+
+    return 1.0 - static_cast<double>(requestedBytes) / static_cast<double>(usedBytes);
+}
+
+
+using MemoryAllocator = VulkanEngine::MemoryAllocator;
+using MemoryAllocation = VulkanEngine::MemoryAllocation;
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device)
+    : MemoryAllocator { physicalDevice, device, MemoryAllocator::DEFAULT_BLOCK_SIZE }
+{
+}
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+    : m_device { device }
+    , m_memoryProperties {}
+    , m_blockSize { std::bit_floor(std::max(blockSize, MemoryAllocator::MIN_ALLOCATION_SIZE)) }
+    , m_blocks {}
+    , m_dedicatedAllocations {}
+{
+    // The memory properties never change for the lifetime of the device, so query them only once.
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+
+    m_blocks.resize(m_memoryProperties.memoryTypeCount);
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    for (auto& blocks : m_blocks) {
+        for (auto& block : blocks) {
+            if (block) {
+                vkFreeMemory(m_device, block->memory, nullptr);
+            }
+        }
+    }
+
+    for (const auto& dedicatedAllocation : m_dedicatedAllocations) {
+        vkFreeMemory(m_device, dedicatedAllocation.memory, nullptr);
+    }
+
+    m_blocks.clear();
+    m_dedicatedAllocations.clear();
+    m_device = VK_NULL_HANDLE;
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties) {
+    const uint32_t memoryTypeIndex = this->findMemoryType(memoryRequirements.memoryTypeBits, properties);
+
+    // A buddy range is aligned to its own size, so rounding the size up to the alignment aligns it too.
+    const VkDeviceSize rangeSize = std::bit_ceil(std::max({
+        memoryRequirements.size,
+        memoryRequirements.alignment,
+        MemoryAllocator::MIN_ALLOCATION_SIZE
+    }));
+    const VkDeviceSize blockSize = this->getBlockSize(memoryTypeIndex);
+    if (rangeSize > blockSize) {
+        return this->allocateDedicated(memoryTypeIndex, memoryRequirements.size);
+    }
+
+    const uint32_t order = MemoryAllocator::getOrder(rangeSize);
+    auto& blocks = m_blocks[memoryTypeIndex];
+    auto offset = VkDeviceSize { 0 };
+    auto blockIndex = std::optional<size_t> {};
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i] && MemoryAllocator::allocateFromBlock(*blocks[i], order, offset)) {
+            blockIndex = i;
+            break;
+        }
+    }
+
+    if (!blockIndex.has_value()) {
+        auto block = this->createBlock(memoryTypeIndex, blockSize);
+        MemoryAllocator::allocateFromBlock(*block, order, offset);
+
+        const auto emptySlot = std::find(blocks.begin(), blocks.end(), nullptr);
+        if (emptySlot != blocks.end()) {
+            *emptySlot = std::move(block);
+            blockIndex = static_cast<size_t>(emptySlot - blocks.begin());
+        } else {
+            blocks.push_back(std::move(block));
+            blockIndex = blocks.size() - 1;
+        }
+    }
+
+    auto& block = *blocks[*blockIndex];
+    block.allocationCount++;
+    block.requestedBytes += memoryRequirements.size;
+
+    return MemoryAllocation {
+        .memory = block.memory,
+        .offset = offset,
+        .size = memoryRequirements.size,
+        .mappedData = (block.mappedData != nullptr) ? static_cast<char*>(block.mappedData) + offset : nullptr,
+        .memoryTypeIndex = memoryTypeIndex,
+        .blockIndex = static_cast<uint32_t>(*blockIndex),
+        .order = order,
+    };
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (allocation.blockIndex == MemoryAllocator::DEDICATED_BLOCK) {
+        const auto dedicatedAllocation = std::find_if(
+            m_dedicatedAllocations.begin(),
+            m_dedicatedAllocations.end(),
+            [&allocation](const auto& dedicatedAllocation) { return dedicatedAllocation.memory == allocation.memory; }
+        );
+        if (dedicatedAllocation == m_dedicatedAllocations.end()) {
+            throw std::runtime_error("failed to free memory that was not allocated by this allocator!");
+        }
+
+        vkFreeMemory(m_device, dedicatedAllocation->memory, nullptr);
+        m_dedicatedAllocations.erase(dedicatedAllocation);
+
+        return;
+    }
+
+    auto& blocks = m_blocks[allocation.memoryTypeIndex];
+    auto& block = blocks[allocation.blockIndex];
+    MemoryAllocator::freeToBlock(*block, allocation.offset, allocation.order);
+    block->allocationCount--;
+    block->requestedBytes -= allocation.size;
+
+    // Keep one block of each memory type around, so that a buffer that is created and destroyed over and
+    // over again does not allocate a fresh block every time.
+    const auto liveBlockCount = std::count_if(blocks.begin(), blocks.end(), [](const auto& block) { return block != nullptr; });
+    if (MemoryAllocator::isBlockEmpty(*block) && liveBlockCount > 1) {
+        vkFreeMemory(m_device, block->memory, nullptr);
+        block.reset();
+    }
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+const VkPhysicalDeviceMemoryProperties& MemoryAllocator::getMemoryProperties() const {
+    return m_memoryProperties;
+}
+
+MemoryStats MemoryAllocator::getStats() const {
+    auto stats = MemoryStats {};
+    for (const auto& blocks : m_blocks) {
+        for (const auto& block : blocks) {
+            if (!block) {
+                continue;
+            }
+
+            stats.blockCount++;
+            stats.allocationCount += block->allocationCount;
+            stats.reservedBytes += block->size;
+            stats.requestedBytes += block->requestedBytes;
+
+            VkDeviceSize blockFreeBytes = 0;
+            for (uint32_t order = 0; order < block->freeLists.size(); order++) {
+                const VkDeviceSize rangeSize = MemoryAllocator::MIN_ALLOCATION_SIZE << order;
+                blockFreeBytes += rangeSize * block->freeLists[order].size();
+                if (!block->freeLists[order].empty()) {
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, rangeSize);
+                }
+            }
+
+            stats.freeBytes += blockFreeBytes;
+            stats.usedBytes += block->size - blockFreeBytes;
+        }
+    }
+
+    for (const auto& dedicatedAllocation : m_dedicatedAllocations) {
+        stats.allocationCount++;
+        stats.reservedBytes += dedicatedAllocation.size;
+        stats.requestedBytes += dedicatedAllocation.size;
+        stats.usedBytes += dedicatedAllocation.size;
+    }
+
+    stats.deviceAllocationCount = stats.blockCount + m_dedicatedAllocations.size();
+
+    return stats;
+}
+
+VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryTypeIndex) const {
+    // Small heaps, like the 256 MiB device local and host visible heap of many discrete GPUs, would be
+    // used up by a couple of full-sized blocks.
+    const uint32_t heapIndex = m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+    const VkDeviceSize maxBlockSize = std::bit_floor(std::max(heapSize / 8, MemoryAllocator::MIN_ALLOCATION_SIZE));
+
+    return std::min(m_blockSize, maxBlockSize);
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** mappedData) {
+    const auto allocInfo = VkMemoryAllocateInfo {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryTypeIndex,
+    };
+
+    auto memory = VkDeviceMemory {};
+    const auto resultAllocateMemory = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+    if (resultAllocateMemory != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+
+    // Memory can only be mapped once at a time, so host visible memory is mapped as a whole for as long as
+    // it lives, and every allocation inside it gets a pointer into that mapping.
+    *mappedData = nullptr;
+    const auto propertyFlags = m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if (propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        const auto resultMapMemory = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, mappedData);
+        if (resultMapMemory != VK_SUCCESS) {
+            vkFreeMemory(m_device, memory, nullptr);
+            throw std::runtime_error("failed to map device memory!");
+        }
+    }
+
+    return memory;
+}
+
+MemoryAllocation MemoryAllocator::allocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size) {
+    void* mappedData = nullptr;
+    const auto memory = this->allocateDeviceMemory(memoryTypeIndex, size, &mappedData);
+
+    m_dedicatedAllocations.push_back(DedicatedAllocation { .memory = memory, .size = size });
+
+    return MemoryAllocation {
+        .memory = memory,
+        .offset = 0,
+        .size = size,
+        .mappedData = mappedData,
+        .memoryTypeIndex = memoryTypeIndex,
+        .blockIndex = MemoryAllocator::DEDICATED_BLOCK,
+        .order = 0,
+    };
+}
+
+std::unique_ptr<MemoryAllocator::Block> MemoryAllocator::createBlock(uint32_t memoryTypeIndex, VkDeviceSize blockSize) {
+    auto block = std::make_unique<Block>();
+    block->memory = this->allocateDeviceMemory(memoryTypeIndex, blockSize, &block->mappedData);
+    block->size = blockSize;
+    block->freeLists.resize(MemoryAllocator::getOrder(blockSize) + 1);
+    block->freeLists.back().insert(0);
+
+    return block;
+}
+
+bool MemoryAllocator::allocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset) {
+    // Take the smallest free range that fits, and split it in halves until it is the right size. The upper
+    // half of every split goes onto the free list one order down.
+    auto sourceOrder = order;
+    while (sourceOrder < block.freeLists.size() && block.freeLists[sourceOrder].empty()) {
+        sourceOrder++;
+    }
+
+    if (sourceOrder >= block.freeLists.size()) {
+        return false;
+    }
+
+    auto& sourceFreeList = block.freeLists[sourceOrder];
+    const VkDeviceSize rangeOffset = *sourceFreeList.begin();
+    sourceFreeList.erase(sourceFreeList.begin());
+
+    while (sourceOrder > order) {
+        sourceOrder--;
+        block.freeLists[sourceOrder].insert(rangeOffset + (MemoryAllocator::MIN_ALLOCATION_SIZE << sourceOrder));
+    }
+
+    offset = rangeOffset;
+
+    return true;
+}
+
+void MemoryAllocator::freeToBlock(Block& block, VkDeviceSize offset, uint32_t order) {
+    // Merge the range with its buddy for as long as the buddy is free too.
+    while (order + 1 < block.freeLists.size()) {
+        const VkDeviceSize buddyOffset = offset ^ (MemoryAllocator::MIN_ALLOCATION_SIZE << order);
+        auto& freeList = block.freeLists[order];
+        const auto buddy = freeList.find(buddyOffset);
+        if (buddy == freeList.end()) {
+            break;
+        }
+
+        freeList.erase(buddy);
+        offset = std::min(offset, buddyOffset);
+        order++;
+    }
+
+    block.freeLists[order].insert(offset);
+}
+
+bool MemoryAllocator::isBlockEmpty(const Block& block) {
+    return !block.freeLists.back().empty();
+}
+
+uint32_t MemoryAllocator::getOrder(VkDeviceSize size) {
+    return static_cast<uint32_t>(std::countr_zero(size / MemoryAllocator::MIN_ALLOCATION_SIZE));
+}
@@ -0,0 +1,121 @@
+#ifndef _MEMORY_ALLOCATOR_H
+#define _MEMORY_ALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// A range of device memory handed out by the `MemoryAllocator`. Resources are bound at `offset` into
+// `memory`, and host visible allocations stay mapped for as long as they live.
+struct MemoryAllocation final {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mappedData = nullptr;
+    uint32_t memoryTypeIndex = 0;
+    // The index of the block the range was carved out of, or `DEDICATED_BLOCK` for a dedicated allocation.
+    uint32_t blockIndex = 0;
+    // The size class of the buddy range, which is `MIN_ALLOCATION_SIZE << order` bytes long.
+    uint32_t order = 0;
+};
+
+struct MemoryStats final {
+    // Device memory objects, counting both pooled blocks and dedicated allocations.
+    size_t deviceAllocationCount = 0;
+    size_t blockCount = 0;
+    size_t allocationCount = 0;
+    VkDeviceSize reservedBytes = 0;
+    // The bytes resources asked for, and the bytes their power of two buddy ranges actually take up.
+    VkDeviceSize requestedBytes = 0;
+    VkDeviceSize usedBytes = 0;
+    VkDeviceSize freeBytes = 0;
+    VkDeviceSize largestFreeRange = 0;
+
+    // The fraction of the free memory in the blocks that a single allocation cannot use. Zero means all
+    // the free memory is one contiguous range.
+    double getExternalFragmentation() const;
+
+    // The fraction of the used memory lost to rounding allocations up to a power of two.
+    double getInternalFragmentation() const;
+};
+
+// Hands out buffer memory from large blocks, one list of blocks per memory type, so that the number of
+// `vkAllocateMemory` calls stays far below the driver's allocation limit. Each block is split with a
+// binary buddy scheme: every range is a power of two long and aligned to its own size, which covers
+// every buffer alignment requirement without padding. Requests larger than a block get a dedicated
+// allocation.
+//
+// Only linear resources (buffers) are suballocated, so `bufferImageGranularity` never comes into play.
+class MemoryAllocator final {
+    public:
+        explicit MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device);
+        explicit MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize);
+
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+        MemoryAllocation allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties);
+
+        void free(const MemoryAllocation& allocation);
+
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+        const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
+
+        MemoryStats getStats() const;
+
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+        static constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+        static constexpr uint32_t DEDICATED_BLOCK = UINT32_MAX;
+    private:
+        struct Block final {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            void* mappedData = nullptr;
+            // The offsets of the free ranges of each order.
+            std::vector<std::set<VkDeviceSize>> freeLists;
+            size_t allocationCount = 0;
+            VkDeviceSize requestedBytes = 0;
+        };
+
+        struct DedicatedAllocation final {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+        };
+
+        VkDevice m_device;
+        VkPhysicalDeviceMemoryProperties m_memoryProperties;
+        VkDeviceSize m_blockSize;
+        // Blocks are never moved once created, and a released block leaves an empty slot behind, so the
+        // block index stored in an allocation stays valid.
+        std::vector<std::vector<std::unique_ptr<Block>>> m_blocks;
+        std::vector<DedicatedAllocation> m_dedicatedAllocations;
+
+        VkDeviceSize getBlockSize(uint32_t memoryTypeIndex) const;
+
+        VkDeviceMemory allocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** mappedData);
+
+        MemoryAllocation allocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size);
+
+        std::unique_ptr<Block> createBlock(uint32_t memoryTypeIndex, VkDeviceSize blockSize);
+
+        static bool allocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset);
+
+        static void freeToBlock(Block& block, VkDeviceSize offset, uint32_t order);
+
+        static bool isBlockEmpty(const Block& block);
+
+        static uint32_t getOrder(VkDeviceSize size);
+};
+
+}
+
+#endif // _MEMORY_ALLOCATOR_H
@@ -0,0 +1,68 @@
+#include "mapped_file.h"
+#include "shader_archive.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+
+using MappedFile = VulkanEngine::MappedFile;
+using ShaderArchive = VulkanEngine::ShaderArchive;
+
+
+// A SPIR-V binary is named after its shader source file, with a `.spv` extension added, and is packed
+// under the name of the source file, the same name the embedded shaders go by.
+static std::string getShaderName(const std::filesystem::path& spirvFile) {
+    if (spirvFile.extension() == ".spv") {
+        return spirvFile.stem().string();
+    }
+
+    return spirvFile.filename().string();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc < 2) {
+            throw std::invalid_argument { "usage: PackShaderArchive <archive> [<spirv file>...]" };
+        }
+
+        const auto archiveFile = std::filesystem::path { argv[1] };
+
+        // The binaries stay mapped until the archive is written, so their code is only copied into the archive.
+        auto spirvFiles = std::vector<MappedFile> {};
+        auto entries = std::vector<ShaderArchive::Entry> {};
+        for (int i = 2; i < argc; i++) {
+            const auto spirvFile = std::filesystem::path { argv[i] };
+            const auto& mappedFile = spirvFiles.emplace_back(spirvFile);
+            const auto bytes = mappedFile.getBytes();
+            if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+                throw std::runtime_error(fmt::format("`{}` is not a whole number of SPIR-V words!", spirvFile.string()));
+            }
+
+            entries.push_back(ShaderArchive::Entry {
+                .name = getShaderName(spirvFile),
+                .code = std::span<const uint32_t> {
+                    reinterpret_cast<const uint32_t*>(bytes.data()),
+                    bytes.size() / sizeof(uint32_t)
+                },
+            });
+        }
+
+        ShaderArchive::write(archiveFile, entries);
+
+        fmt::println("Packed {} shaders into `{}`", entries.size(), archiveFile.string());
+    } catch (const std::exception& exception) {
+        fmt::println(std::cerr, "{}", exception.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
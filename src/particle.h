@@ -0,0 +1,107 @@
+#ifndef _PARTICLE_H
+#define _PARTICLE_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+
+struct Particle {
+    glm::vec2 position;
+    glm::vec2 velocity;
+    glm::vec4 color;
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        const auto bindingDescription = VkVertexInputBindingDescription {
+            .binding = 0,
+            .stride = sizeof(Particle),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        };
+
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+        const auto attributeDescriptions = std::array<VkVertexInputAttributeDescription, 2> {
+            VkVertexInputAttributeDescription {
+                .location = 0,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32_SFLOAT,
+                .offset = offsetof(Particle, position),
+            },
+            VkVertexInputAttributeDescription {
+                .location = 1,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = offsetof(Particle, color),
+            }
+        };
+
+        return attributeDescriptions;
+    }
+};
+
+// The structure of arrays counterpart of `Particle`. Positions and velocities live in separate buffers
+// so the compute shader never touches the colors, which are uploaded once and only read by the vertex
+// shader through a second vertex binding.
+struct ParticleArrays {
+    std::vector<glm::vec2> positions;
+    std::vector<glm::vec2> velocities;
+    std::vector<glm::vec4> colors;
+
+    explicit ParticleArrays(size_t particleCount)
+        : positions(particleCount)
+        , velocities(particleCount)
+        , colors(particleCount)
+    {
+    }
+
+    size_t size() const {
+        return positions.size();
+    }
+
+    static std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions() {
+        const auto bindingDescriptions = std::array<VkVertexInputBindingDescription, 2> {
+            VkVertexInputBindingDescription {
+                .binding = 0,
+                .stride = sizeof(glm::vec2),
+                .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+            },
+            VkVertexInputBindingDescription {
+                .binding = 1,
+                .stride = sizeof(glm::vec4),
+                .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+            }
+        };
+
+        return bindingDescriptions;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+        const auto attributeDescriptions = std::array<VkVertexInputAttributeDescription, 2> {
+            VkVertexInputAttributeDescription {
+                .location = 0,
+                .binding = 0,
+                .format = VK_FORMAT_R32G32_SFLOAT,
+                .offset = 0,
+            },
+            VkVertexInputAttributeDescription {
+                .location = 1,
+                .binding = 1,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = 0,
+            }
+        };
+
+        return attributeDescriptions;
+    }
+};
+
+#endif // _PARTICLE_H
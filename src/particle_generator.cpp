@@ -0,0 +1,71 @@
+#include "particle_generator.h"
+
+#include <random>
+
+#include <glm/gtc/constants.hpp>
+
+
+// Large enough to amortize scheduling a chunk, small enough that every thread gets several chunks.
+const size_t GENERATOR_CHUNK_SIZE = 16384;
+
+
+ParticleGenerator::ParticleGenerator(uint64_t seed, float aspectRatio)
+    : m_key { Philox4x32::keyFromSeed(seed) }
+    , m_aspectRatio { aspectRatio }
+{
+}
+
+Particle ParticleGenerator::generateParticle(uint64_t index) const {
+    // The particle index is the low half of the counter, and the block number the third word, so every
+    // particle owns its own stream of random words.
+    const auto counter = Philox4x32::Counter { static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), 0, 0 };
+    const auto block0 = Philox4x32::generate(counter, m_key);
+    const auto block1 = Philox4x32::generate(Philox4x32::Counter { counter[0], counter[1], 1, 0 }, m_key);
+
+    const float r = 0.25f * glm::sqrt(Philox4x32::toUniformFloat(block0[0]));
+    const float theta = Philox4x32::toUniformFloat(block0[1]) * 2.0f * glm::pi<float>();
+    const float x = r * glm::cos(theta) * m_aspectRatio;
+    const float y = r * glm::sin(theta);
+
+    auto particle = Particle {};
+    particle.position = glm::vec2(x, y);
+    particle.velocity = glm::normalize(glm::vec2(x, y)) * 0.00025f;
+    particle.color = glm::vec4(
+        Philox4x32::toUniformFloat(block0[2]),
+        Philox4x32::toUniformFloat(block0[3]),
+        Philox4x32::toUniformFloat(block1[0]),
+        1.0f
+    );
+
+    return particle;
+}
+
+void ParticleGenerator::generate(std::span<Particle> particles, uint64_t firstIndex) const {
+    for (size_t i = 0; i < particles.size(); i++) {
+        particles[i] = this->generateParticle(firstIndex + i);
+    }
+}
+
+void ParticleGenerator::generate(std::span<Particle> particles, ThreadPool& threadPool) const {
+    threadPool.parallelFor(particles.size(), GENERATOR_CHUNK_SIZE, [&](size_t begin, size_t end) {
+        this->generate(particles.subspan(begin, end - begin), begin);
+    });
+}
+
+void ParticleGenerator::generate(ParticleArrays& particles, ThreadPool& threadPool) const {
+    threadPool.parallelFor(particles.size(), GENERATOR_CHUNK_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const auto particle = this->generateParticle(i);
+
+            particles.positions[i] = particle.position;
+            particles.velocities[i] = particle.velocity;
+            particles.colors[i] = particle.color;
+        }
+    });
+}
+
+uint64_t ParticleGenerator::createRandomSeed() {
+    auto randomDevice = std::random_device {};
+
+    return (static_cast<uint64_t>(randomDevice()) << 32) | randomDevice();
+}
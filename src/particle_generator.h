@@ -0,0 +1,33 @@
+#ifndef _PARTICLE_GENERATOR_H
+#define _PARTICLE_GENERATOR_H
+
+#include "particle.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+
+// Generates the initial particle system: particles scattered over a disc, moving outwards from its
+// center. Particle `i` is a pure function of the seed and `i`, drawn from the Philox4x32-10
+// counter-based generator, so the particles can be generated in any order, on any number of threads,
+// and come out bit-identical for a given seed.
+class ParticleGenerator final {
+    public:
+        explicit ParticleGenerator(uint64_t seed, float aspectRatio);
+
+        Particle generateParticle(uint64_t index) const;
+
+        void generate(std::span<Particle> particles, uint64_t firstIndex) const;
+        void generate(std::span<Particle> particles, ThreadPool& threadPool) const;
+        void generate(ParticleArrays& particles, ThreadPool& threadPool) const;
+
+        static uint64_t createRandomSeed();
+    private:
+        Philox4x32::Key m_key;
+        float m_aspectRatio;
+};
+
+#endif // _PARTICLE_GENERATOR_H
@@ -0,0 +1,243 @@
+#include "particle_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PARTICLE_INTEGRATOR_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define PARTICLE_INTEGRATOR_X86_SIMD 0
+#endif
+
+
+// The vectorized kernels load the position and velocity of a particle together as four packed floats,
+// followed by the color.
+static_assert(offsetof(Particle, position) == 0);
+static_assert(offsetof(Particle, velocity) == offsetof(Particle, position) + sizeof(glm::vec2));
+static_assert(offsetof(Particle, color) == offsetof(Particle, velocity) + sizeof(glm::vec2));
+static_assert(sizeof(Particle) == 2 * 4 * sizeof(float));
+
+
+static void integrateScalar(const Particle* particlesIn, Particle* particlesOut, size_t count, float deltaTime) {
+    for (size_t i = 0; i < count; i++) {
+        const auto particleIn = particlesIn[i];
+
+        auto particleOut = Particle {};
+        particleOut.position = particleIn.position + particleIn.velocity * deltaTime;
+        particleOut.velocity = particleIn.velocity;
+        particleOut.color = particleIn.color;
+
+        // Flip movement at window border
+        if ((particleOut.position.x <= -1.0f) || (particleOut.position.x >= 1.0f)) {
+            particleOut.velocity.x = -particleOut.velocity.x;
+        }
+        if ((particleOut.position.y <= -1.0f) || (particleOut.position.y >= 1.0f)) {
+            particleOut.velocity.y = -particleOut.velocity.y;
+        }
+
+        particlesOut[i] = particleOut;
+    }
+}
+
+#if PARTICLE_INTEGRATOR_X86_SIMD
+
+// Integrates two particles per iteration. The positions of both particles are gathered into one
+// register and their velocities into another, so every lane does useful work.
+__attribute__((target("sse4.1")))
+static void integrateSSE4(const Particle* particlesIn, Particle* particlesOut, size_t count, float deltaTime) {
+    const __m128 deltaTimes = _mm_set1_ps(deltaTime);
+    const __m128 lowerBorder = _mm_set1_ps(-1.0f);
+    const __m128 upperBorder = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        // Each state holds (position.x, position.y, velocity.x, velocity.y).
+        const __m128 state0 = _mm_loadu_ps(&particlesIn[i].position.x);
+        const __m128 state1 = _mm_loadu_ps(&particlesIn[i + 1].position.x);
+        const __m128 color0 = _mm_loadu_ps(&particlesIn[i].color.x);
+        const __m128 color1 = _mm_loadu_ps(&particlesIn[i + 1].color.x);
+
+        const __m128 positions = _mm_movelh_ps(state0, state1);
+        const __m128 velocities = _mm_movehl_ps(state1, state0);
+
+        const __m128 newPositions = _mm_add_ps(positions, _mm_mul_ps(velocities, deltaTimes));
+        const __m128 outside = _mm_or_ps(_mm_cmple_ps(newPositions, lowerBorder), _mm_cmpge_ps(newPositions, upperBorder));
+        const __m128 newVelocities = _mm_blendv_ps(velocities, _mm_xor_ps(velocities, signMask), outside);
+
+        _mm_storeu_ps(&particlesOut[i].position.x, _mm_movelh_ps(newPositions, newVelocities));
+        _mm_storeu_ps(&particlesOut[i + 1].position.x, _mm_movehl_ps(newVelocities, newPositions));
+        _mm_storeu_ps(&particlesOut[i].color.x, color0);
+        _mm_storeu_ps(&particlesOut[i + 1].color.x, color1);
+    }
+
+    integrateScalar(particlesIn + i, particlesOut + i, count - i, deltaTime);
+}
+
+// Integrates four particles per iteration. Each particle is loaded whole, and the lane permutes pair
+// up particles 0 and 2, and particles 1 and 3, so the in-lane shuffles of the SSE kernel carry over.
+__attribute__((target("avx2")))
+static void integrateAVX2(const Particle* particlesIn, Particle* particlesOut, size_t count, float deltaTime) {
+    const __m256 deltaTimes = _mm256_set1_ps(deltaTime);
+    const __m256 lowerBorder = _mm256_set1_ps(-1.0f);
+    const __m256 upperBorder = _mm256_set1_ps(1.0f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Each particle holds (position.x, position.y, velocity.x, velocity.y | color).
+        const __m256 particle0 = _mm256_loadu_ps(&particlesIn[i].position.x);
+        const __m256 particle1 = _mm256_loadu_ps(&particlesIn[i + 1].position.x);
+        const __m256 particle2 = _mm256_loadu_ps(&particlesIn[i + 2].position.x);
+        const __m256 particle3 = _mm256_loadu_ps(&particlesIn[i + 3].position.x);
+
+        const __m256 state02 = _mm256_permute2f128_ps(particle0, particle2, 0x20);
+        const __m256 state13 = _mm256_permute2f128_ps(particle1, particle3, 0x20);
+        const __m256 color02 = _mm256_permute2f128_ps(particle0, particle2, 0x31);
+        const __m256 color13 = _mm256_permute2f128_ps(particle1, particle3, 0x31);
+
+        const __m256 positions = _mm256_shuffle_ps(state02, state13, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 velocities = _mm256_shuffle_ps(state02, state13, _MM_SHUFFLE(3, 2, 3, 2));
+
+        const __m256 newPositions = _mm256_add_ps(positions, _mm256_mul_ps(velocities, deltaTimes));
+        const __m256 outside = _mm256_or_ps(
+            _mm256_cmp_ps(newPositions, lowerBorder, _CMP_LE_OQ),
+            _mm256_cmp_ps(newPositions, upperBorder, _CMP_GE_OQ)
+        );
+        const __m256 newVelocities = _mm256_blendv_ps(velocities, _mm256_xor_ps(velocities, signMask), outside);
+
+        const __m256 newState02 = _mm256_shuffle_ps(newPositions, newVelocities, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 newState13 = _mm256_shuffle_ps(newPositions, newVelocities, _MM_SHUFFLE(3, 2, 3, 2));
+
+        _mm256_storeu_ps(&particlesOut[i].position.x, _mm256_permute2f128_ps(newState02, color02, 0x20));
+        _mm256_storeu_ps(&particlesOut[i + 1].position.x, _mm256_permute2f128_ps(newState13, color13, 0x20));
+        _mm256_storeu_ps(&particlesOut[i + 2].position.x, _mm256_permute2f128_ps(newState02, color02, 0x31));
+        _mm256_storeu_ps(&particlesOut[i + 3].position.x, _mm256_permute2f128_ps(newState13, color13, 0x31));
+    }
+
+    integrateSSE4(particlesIn + i, particlesOut + i, count - i, deltaTime);
+}
+
+#endif // PARTICLE_INTEGRATOR_X86_SIMD
+
+
+ParticleIntegrator::ParticleIntegrator()
+    : m_simdLevel { ParticleIntegrator::detectSimdLevel() }
+{
+}
+
+ParticleIntegrator::ParticleIntegrator(SimdLevel simdLevel)
+    : m_simdLevel { simdLevel }
+{
+    if (!ParticleIntegrator::isSupported(simdLevel)) {
+        throw std::runtime_error(fmt::format(
+            "the `{}` particle integrator is not supported on this CPU!",
+            ParticleIntegrator::simdLevelToString(simdLevel)
+        ));
+    }
+}
+
+SimdLevel ParticleIntegrator::getSimdLevel() const {
+    return m_simdLevel;
+}
+
+void ParticleIntegrator::integrate(std::span<const Particle> particlesIn, std::span<Particle> particlesOut, float deltaTime) const {
+    if (particlesIn.size() != particlesOut.size()) {
+        throw std::runtime_error("particle integrator input and output sizes do not match!");
+    }
+
+    switch (m_simdLevel) {
+#if PARTICLE_INTEGRATOR_X86_SIMD
+        case SimdLevel::AVX2:
+            integrateAVX2(particlesIn.data(), particlesOut.data(), particlesIn.size(), deltaTime);
+            break;
+        case SimdLevel::SSE4:
+            integrateSSE4(particlesIn.data(), particlesOut.data(), particlesIn.size(), deltaTime);
+            break;
+#endif // PARTICLE_INTEGRATOR_X86_SIMD
+        default:
+            integrateScalar(particlesIn.data(), particlesOut.data(), particlesIn.size(), deltaTime);
+            break;
+    }
+}
+
+SimdLevel ParticleIntegrator::detectSimdLevel() {
+    if (ParticleIntegrator::isSupported(SimdLevel::AVX2)) {
+        return SimdLevel::AVX2;
+    } else if (ParticleIntegrator::isSupported(SimdLevel::SSE4)) {
+        return SimdLevel::SSE4;
+    }
+
+    return SimdLevel::Scalar;
+}
+
+bool ParticleIntegrator::isSupported(SimdLevel simdLevel) {
+    switch (simdLevel) {
+#if PARTICLE_INTEGRATOR_X86_SIMD
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case SimdLevel::SSE4:
+            return __builtin_cpu_supports("sse4.1");
+#endif // PARTICLE_INTEGRATOR_X86_SIMD
+        case SimdLevel::Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::vector<SimdLevel> ParticleIntegrator::getSupportedSimdLevels() {
+    auto supportedSimdLevels = std::vector<SimdLevel> {};
+    for (const auto simdLevel : { SimdLevel::Scalar, SimdLevel::SSE4, SimdLevel::AVX2 }) {
+        if (ParticleIntegrator::isSupported(simdLevel)) {
+            supportedSimdLevels.push_back(simdLevel);
+        }
+    }
+
+    return supportedSimdLevels;
+}
+
+const std::string& ParticleIntegrator::simdLevelToString(SimdLevel simdLevel) {
+    static const std::string SIMD_LEVEL_SCALAR = std::string { "scalar" };
+    static const std::string SIMD_LEVEL_SSE4 = std::string { "sse4" };
+    static const std::string SIMD_LEVEL_AVX2 = std::string { "avx2" };
+
+    switch (simdLevel) {
+        case SimdLevel::SSE4: return SIMD_LEVEL_SSE4;
+        case SimdLevel::AVX2: return SIMD_LEVEL_AVX2;
+        default: return SIMD_LEVEL_SCALAR;
+    }
+}
+
+
+ParticleComparison compareParticles(std::span<const Particle> expected, std::span<const Particle> actual, float tolerance) {
+    if (expected.size() != actual.size()) {
+        throw std::runtime_error("cannot compare particle systems of different sizes!");
+    }
+
+    auto comparison = ParticleComparison {};
+    for (size_t i = 0; i < expected.size(); i++) {
+        const auto positionError = glm::abs(expected[i].position - actual[i].position);
+        const auto velocityError = glm::abs(expected[i].velocity - actual[i].velocity);
+        const float error = std::max({ positionError.x, positionError.y, velocityError.x, velocityError.y });
+
+        // Written so that a NaN on either side counts as a mismatch.
+        const bool isWithinTolerance = (positionError.x <= tolerance) && (positionError.y <= tolerance)
+            && (velocityError.x <= tolerance) && (velocityError.y <= tolerance);
+        if (!isWithinTolerance) {
+            if (comparison.mismatchCount == 0) {
+                comparison.firstMismatchIndex = i;
+            }
+
+            comparison.mismatchCount++;
+        }
+
+        comparison.maxAbsoluteError = std::max(comparison.maxAbsoluteError, error);
+    }
+
+    return comparison;
+}
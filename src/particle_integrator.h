@@ -0,0 +1,54 @@
+#ifndef _PARTICLE_INTEGRATOR_H
+#define _PARTICLE_INTEGRATOR_H
+
+#include "particle.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+
+enum class SimdLevel {
+    Scalar,
+    SSE4,
+    AVX2
+};
+
+// A CPU implementation of the particle update in `shader_compute.comp`. Every instruction set
+// produces bit-identical results, since none of them fuse the multiply and add of the position
+// update. The GPU is free to fuse them, so compare against the GPU with `compareParticles`
+// instead of requiring exact equality.
+class ParticleIntegrator final {
+    public:
+        explicit ParticleIntegrator();
+        explicit ParticleIntegrator(SimdLevel simdLevel);
+
+        SimdLevel getSimdLevel() const;
+
+        // The input and output may be the same span, but must not otherwise overlap.
+        void integrate(std::span<const Particle> particlesIn, std::span<Particle> particlesOut, float deltaTime) const;
+
+        static SimdLevel detectSimdLevel();
+        static bool isSupported(SimdLevel simdLevel);
+        static std::vector<SimdLevel> getSupportedSimdLevels();
+        static const std::string& simdLevelToString(SimdLevel simdLevel);
+    private:
+        SimdLevel m_simdLevel;
+};
+
+struct ParticleComparison final {
+    size_t mismatchCount = 0;
+    size_t firstMismatchIndex = 0;
+    float maxAbsoluteError = 0.0f;
+
+    bool isMatch() const {
+        return mismatchCount == 0;
+    }
+};
+
+// Compares the positions and velocities of two particle systems component-wise. Colors are
+// ignored, since the simulation never changes them.
+ParticleComparison compareParticles(std::span<const Particle> expected, std::span<const Particle> actual, float tolerance);
+
+#endif // _PARTICLE_INTEGRATOR_H
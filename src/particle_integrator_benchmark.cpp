@@ -0,0 +1,149 @@
+#include "particle.h"
+#include "particle_integrator.h"
+#include "cpu_particle_simulation.h"
+#include "thread_pool.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+
+const uint32_t DEFAULT_PARTICLE_COUNT = 1 << 20;
+const uint32_t DEFAULT_ITERATION_COUNT = 200;
+
+// The same step length the demo uses when simulating headlessly, scaled the same way.
+const float DELTA_TIME = 2.0f * 1000.0f / 60.0f;
+
+
+static uint32_t parseUint32(std::string_view argument, std::string_view value) {
+    uint32_t result = 0;
+    const auto [end, errorCode] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (errorCode != std::errc {} || end != value.data() + value.size() || result == 0) {
+        throw std::invalid_argument { fmt::format("expected a positive integer for `{}`, got `{}`", argument, value) };
+    }
+
+    return result;
+}
+
+static std::vector<Particle> generateParticles(uint32_t particleCount) {
+    auto rndEngine = std::default_random_engine { 0 };
+    auto positionDist = std::uniform_real_distribution<float> { -1.0f, 1.0f };
+    auto velocityDist = std::uniform_real_distribution<float> { -0.00025f, 0.00025f };
+
+    auto particles = std::vector<Particle> { particleCount };
+    for (auto& particle : particles) {
+        particle.position = glm::vec2(positionDist(rndEngine), positionDist(rndEngine));
+        particle.velocity = glm::vec2(velocityDist(rndEngine), velocityDist(rndEngine));
+        particle.color = glm::vec4(1.0f);
+    }
+
+    return particles;
+}
+
+static std::vector<Particle> runIntegrator(const ParticleIntegrator& integrator, const std::vector<Particle>& initialParticles, uint32_t iterationCount, double& elapsedSeconds) {
+    auto particlesIn = initialParticles;
+    auto particlesOut = std::vector<Particle> { initialParticles.size() };
+
+    const auto startTime = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterationCount; i++) {
+        integrator.integrate(particlesIn, particlesOut, DELTA_TIME);
+        std::swap(particlesIn, particlesOut);
+    }
+    elapsedSeconds = std::chrono::duration<double> { std::chrono::steady_clock::now() - startTime }.count();
+
+    return particlesIn;
+}
+
+static double runSimulation(const std::vector<Particle>& initialParticles, size_t threadCount, uint32_t iterationCount) {
+    auto simulation = CpuParticleSimulation { initialParticles, 2, threadCount };
+
+    const auto startTime = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterationCount; i++) {
+        simulation.step(i % 2, DELTA_TIME, 1);
+    }
+
+    return std::chrono::duration<double> { std::chrono::steady_clock::now() - startTime }.count();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        uint32_t particleCount = DEFAULT_PARTICLE_COUNT;
+        uint32_t iterationCount = DEFAULT_ITERATION_COUNT;
+        size_t maxThreadCount = ThreadPool::getDefaultThreadCount();
+        for (int i = 1; i < argc; i++) {
+            const auto argument = std::string_view { argv[i] };
+            if ((argument == "--particles" || argument == "--iterations" || argument == "--threads") && (i + 1 < argc)) {
+                const auto value = parseUint32(argument, argv[++i]);
+                if (argument == "--particles") {
+                    particleCount = value;
+                } else if (argument == "--iterations") {
+                    iterationCount = value;
+                } else {
+                    maxThreadCount = value;
+                }
+            } else {
+                throw std::invalid_argument { fmt::format("unrecognized argument `{}`", argument) };
+            }
+        }
+
+        const auto initialParticles = generateParticles(particleCount);
+        const auto referenceIntegrator = ParticleIntegrator { SimdLevel::Scalar };
+        double referenceSeconds = 0.0;
+        const auto referenceParticles = runIntegrator(referenceIntegrator, initialParticles, iterationCount, referenceSeconds);
+
+        fmt::println("Integrating {} particles for {} iterations", particleCount, iterationCount);
+        for (const auto simdLevel : ParticleIntegrator::getSupportedSimdLevels()) {
+            const auto integrator = ParticleIntegrator { simdLevel };
+            double elapsedSeconds = 0.0;
+            const auto particles = runIntegrator(integrator, initialParticles, iterationCount, elapsedSeconds);
+
+            // Every instruction set must reproduce the scalar integrator exactly.
+            const auto comparison = compareParticles(referenceParticles, particles, 0.0f);
+            const double particlesPerSecond = (static_cast<double>(particleCount) * iterationCount) / elapsedSeconds;
+            fmt::println(
+                "{:<8} {:>10.2f} Mparticles/s  {:>6.2f}x  {}",
+                ParticleIntegrator::simdLevelToString(simdLevel),
+                particlesPerSecond / 1.0e6,
+                referenceSeconds / elapsedSeconds,
+                comparison.isMatch() ? "matches scalar" : "MISMATCH"
+            );
+        }
+
+        // Thread scaling of the CPU simulation backend with the best integrator available.
+        auto threadCounts = std::vector<size_t> {};
+        for (size_t threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+            threadCounts.push_back(threadCount);
+        }
+        threadCounts.push_back(maxThreadCount);
+
+        double singleThreadSeconds = 0.0;
+        for (const auto threadCount : threadCounts) {
+            const double elapsedSeconds = runSimulation(initialParticles, threadCount, iterationCount);
+            if (threadCount == 1) {
+                singleThreadSeconds = elapsedSeconds;
+            }
+
+            const double particlesPerSecond = (static_cast<double>(particleCount) * iterationCount) / elapsedSeconds;
+            fmt::println(
+                "{:>3} threads {:>10.2f} Mparticles/s  {:>6.2f}x",
+                threadCount,
+                particlesPerSecond / 1.0e6,
+                singleThreadSeconds / elapsedSeconds
+            );
+        }
+    } catch (const std::exception& e) {
+        fmt::println(std::cerr, "{}", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
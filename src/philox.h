@@ -0,0 +1,67 @@
+#ifndef _PHILOX_H
+#define _PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+
+// The Philox4x32-10 counter-based random number generator of Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3". Every output block is a pure function of a 128-bit counter and a 64-bit key, so
+// any block can be computed independently of every other, in any order, on any thread or device.
+namespace Philox4x32 {
+
+using Counter = std::array<uint32_t, 4>;
+using Key = std::array<uint32_t, 2>;
+
+const uint32_t MULTIPLIER_0 = 0xD2511F53;
+const uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+const uint32_t WEYL_0 = 0x9E3779B9;
+const uint32_t WEYL_1 = 0xBB67AE85;
+const int ROUND_COUNT = 10;
+
+constexpr Counter round(const Counter& counter, const Key& key) {
+    const uint64_t product0 = static_cast<uint64_t>(MULTIPLIER_0) * counter[0];
+    const uint64_t product1 = static_cast<uint64_t>(MULTIPLIER_1) * counter[2];
+    const uint32_t hi0 = static_cast<uint32_t>(product0 >> 32);
+    const uint32_t lo0 = static_cast<uint32_t>(product0);
+    const uint32_t hi1 = static_cast<uint32_t>(product1 >> 32);
+    const uint32_t lo1 = static_cast<uint32_t>(product1);
+
+    return Counter { hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0 };
+}
+
+constexpr Counter generate(Counter counter, Key key) {
+    for (int i = 0; i < ROUND_COUNT; i++) {
+        if (i > 0) {
+            key = Key { key[0] + WEYL_0, key[1] + WEYL_1 };
+        }
+
+        counter = Philox4x32::round(counter, key);
+    }
+
+    return counter;
+}
+
+constexpr Key keyFromSeed(uint64_t seed) {
+    return Key { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+}
+
+// Maps the top 24 bits of a random word onto a float in [0, 1), every value of which is exactly representable.
+constexpr float toUniformFloat(uint32_t value) {
+    return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+}
+
+// Known answer tests from the Random123 distribution.
+static_assert(Philox4x32::generate(Counter { 0, 0, 0, 0 }, Key { 0, 0 }) == Counter { 0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8 });
+static_assert(
+    Philox4x32::generate(Counter { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }, Key { 0xFFFFFFFF, 0xFFFFFFFF })
+    == Counter { 0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD }
+);
+static_assert(
+    Philox4x32::generate(Counter { 0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344 }, Key { 0xA4093822, 0x299F31D0 })
+    == Counter { 0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1 }
+);
+
+}
+
+#endif // _PHILOX_H
@@ -0,0 +1,84 @@
+#include "pipeline_builder.h"
+
+#include <algorithm>
+#include <exception>
+
+
+using PipelineBuilder = VulkanEngine::PipelineBuilder;
+
+PipelineBuilder::PipelineBuilder(bool isParallel)
+    : m_isParallel { isParallel }
+    , m_builds {}
+    , m_pipelineCount { 0 }
+    , m_startTime {}
+    , m_finishTime {}
+{
+}
+
+PipelineBuilder::~PipelineBuilder() {
+    for (auto& build : m_builds) {
+        if (build.valid()) {
+            build.wait();
+        }
+    }
+}
+
+bool PipelineBuilder::isParallel() const {
+    return m_isParallel;
+}
+
+void PipelineBuilder::add(BuildTask task) {
+    if (!m_startTime.has_value()) {
+        m_startTime = Clock::now();
+    }
+
+    m_pipelineCount++;
+
+    if (!m_isParallel) {
+        m_finishTime = PipelineBuilder::runBuild(task);
+
+        return;
+    }
+
+    m_builds.push_back(std::async(std::launch::async, [task = std::move(task)]() {
+        return PipelineBuilder::runBuild(task);
+    }));
+}
+
+void PipelineBuilder::wait() {
+    // Every build is waited for before rethrowing, so that none is left writing into the caller's state.
+    auto exception = std::exception_ptr {};
+    for (auto& build : m_builds) {
+        try {
+            m_finishTime = std::max(m_finishTime, build.get());
+        } catch (...) {
+            if (!exception) {
+                exception = std::current_exception();
+            }
+        }
+    }
+
+    m_builds.clear();
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+size_t PipelineBuilder::getPipelineCount() const {
+    return m_pipelineCount;
+}
+
+std::chrono::steady_clock::duration PipelineBuilder::getBuildTime() const {
+    if (!m_startTime.has_value()) {
+        return Clock::duration::zero();
+    }
+
+    return m_finishTime - *m_startTime;
+}
+
+PipelineBuilder::Clock::time_point PipelineBuilder::runBuild(const BuildTask& task) {
+    task();
+
+    return Clock::now();
+}
@@ -0,0 +1,61 @@
+#ifndef _PIPELINE_BUILDER_H
+#define _PIPELINE_BUILDER_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <optional>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Builds independent pipelines on threads of their own while the calling thread goes on with the rest
+// of the setup, such as allocating buffers and generating particles. Most of the time a pipeline takes
+// to create goes into the driver compiling its shaders, and drivers compile pipelines created on
+// different threads side by side. A `VkPipelineCache` is synchronized by the driver, so every build
+// can share the same cache.
+//
+// A build only touches the state it creates, and the caller must not read that state before `wait`
+// returns. A serial builder runs every build right away on the calling thread instead, which is the
+// baseline the parallel startup is measured against.
+class PipelineBuilder final {
+    public:
+        using BuildTask = std::function<void()>;
+
+        explicit PipelineBuilder(bool isParallel);
+
+        // Waits for the builds still running, since they write into state owned by the caller.
+        ~PipelineBuilder();
+
+        PipelineBuilder(const PipelineBuilder&) = delete;
+        PipelineBuilder& operator=(const PipelineBuilder&) = delete;
+
+        bool isParallel() const;
+
+        void add(BuildTask task);
+
+        // Blocks until every build has finished. The first exception thrown by a build is rethrown on the
+        // calling thread.
+        void wait();
+
+        size_t getPipelineCount() const;
+
+        // The time from adding the first build to the last build finishing.
+        std::chrono::steady_clock::duration getBuildTime() const;
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool m_isParallel;
+        std::vector<std::future<Clock::time_point>> m_builds;
+        size_t m_pipelineCount;
+        std::optional<Clock::time_point> m_startTime;
+        Clock::time_point m_finishTime;
+
+        static Clock::time_point runBuild(const BuildTask& task);
+};
+
+}
+
+#endif // _PIPELINE_BUILDER_H
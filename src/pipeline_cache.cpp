@@ -0,0 +1,174 @@
+#include "pipeline_cache.h"
+
+#include "mapped_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+
+using PipelineCache = VulkanEngine::PipelineCache;
+using PipelineCacheLoadStatus = VulkanEngine::PipelineCacheLoadStatus;
+
+PipelineCache::PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device)
+    : m_physicalDevice { physicalDevice }
+    , m_device { device }
+    , m_pipelineCache { VK_NULL_HANDLE }
+    , m_filePath {}
+    , m_loadStatus { PipelineCacheLoadStatus::InMemory }
+    , m_loadedSize { 0 }
+    , m_persistedData {}
+{
+    m_pipelineCache = this->createPipelineCache(std::vector<char> {});
+}
+
+PipelineCache::PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::filesystem::path& filePath)
+    : m_physicalDevice { physicalDevice }
+    , m_device { device }
+    , m_pipelineCache { VK_NULL_HANDLE }
+    , m_filePath { filePath }
+    , m_loadStatus { PipelineCacheLoadStatus::Missing }
+    , m_loadedSize { 0 }
+    , m_persistedData {}
+{
+    auto errorCode = std::error_code {};
+    if (std::filesystem::exists(filePath, errorCode)) {
+        auto data = this->readFile(filePath);
+        if (this->isCompatible(data)) {
+            m_persistedData = std::move(data);
+            m_loadStatus = PipelineCacheLoadStatus::Loaded;
+        } else {
+            m_loadStatus = PipelineCacheLoadStatus::Rejected;
+        }
+    }
+
+    if (m_loadStatus == PipelineCacheLoadStatus::Loaded) {
+        try {
+            m_pipelineCache = this->createPipelineCache(m_persistedData);
+            m_loadedSize = m_persistedData.size();
+
+            return;
+        } catch (const std::runtime_error&) {
+            // The header checked out, but the driver still refused the data behind it.
+            m_persistedData.clear();
+            m_loadStatus = PipelineCacheLoadStatus::Rejected;
+        }
+    }
+
+    m_pipelineCache = this->createPipelineCache(std::vector<char> {});
+}
+
+PipelineCache::~PipelineCache() {
+    vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+
+    m_pipelineCache = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+    m_physicalDevice = VK_NULL_HANDLE;
+}
+
+VkPipelineCache PipelineCache::getHandle() const {
+    return m_pipelineCache;
+}
+
+const std::filesystem::path& PipelineCache::getFilePath() const {
+    return m_filePath;
+}
+
+PipelineCacheLoadStatus PipelineCache::getLoadStatus() const {
+    return m_loadStatus;
+}
+
+size_t PipelineCache::getLoadedSize() const {
+    return m_loadedSize;
+}
+
+bool PipelineCache::save() {
+    if (m_loadStatus == PipelineCacheLoadStatus::InMemory) {
+        return false;
+    }
+
+    size_t dataSize = 0;
+    const auto resultGetSize = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr);
+    if (resultGetSize != VK_SUCCESS) {
+        throw std::runtime_error("failed to get pipeline cache data size!");
+    }
+
+    auto data = std::vector<char>(dataSize);
+    const auto resultGetData = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data());
+    if (resultGetData != VK_SUCCESS) {
+        throw std::runtime_error("failed to get pipeline cache data!");
+    }
+
+    data.resize(dataSize);
+
+    // Every process that starts from the same file and creates the same pipelines ends up with the same
+    // data, and skipping the write spares the file system when many of them run side by side.
+    if (data == m_persistedData) {
+        return false;
+    }
+
+    VulkanEngine::writeFileAtomically(m_filePath, "pipeline cache file", [&data](std::ofstream& file) {
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    });
+    m_persistedData = std::move(data);
+
+    return true;
+}
+
+bool PipelineCache::isCompatible(const std::vector<char>& data) const {
+    auto header = VkPipelineCacheHeaderVersionOne {};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (header.headerSize < sizeof(header) || header.headerSize > data.size()) {
+        return false;
+    }
+
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+        return false;
+    }
+
+    auto properties = VkPhysicalDeviceProperties {};
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+    return (header.vendorID == properties.vendorID)
+        && (header.deviceID == properties.deviceID)
+        && (memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+}
+
+std::vector<char> PipelineCache::readFile(const std::filesystem::path& filePath) const {
+    auto file = std::ifstream { filePath, std::ios::ate | std::ios::binary };
+    if (!file.is_open()) {
+        return std::vector<char> {};
+    }
+
+    const auto fileSize = static_cast<size_t>(file.tellg());
+    auto data = std::vector<char>(fileSize);
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(fileSize));
+    if (!file) {
+        return std::vector<char> {};
+    }
+
+    return data;
+}
+
+VkPipelineCache PipelineCache::createPipelineCache(const std::vector<char>& initialData) const {
+    const auto createInfo = VkPipelineCacheCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = initialData.size(),
+        .pInitialData = initialData.empty() ? nullptr : initialData.data(),
+    };
+
+    auto pipelineCache = VkPipelineCache {};
+    const auto result = vkCreatePipelineCache(m_device, &createInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    return pipelineCache;
+}
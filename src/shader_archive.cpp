@@ -0,0 +1,203 @@
+#include "shader_archive.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <fmt/core.h>
+
+
+using ShaderArchive = VulkanEngine::ShaderArchive;
+
+// An archive starts with a header, followed by one entry per shader, the names of the shaders, and
+// finally the code of the shaders. Offsets count from the start of the file, and numbers are stored in
+// the byte order of the machine that packed the archive, which the magic number gives away.
+struct ArchiveHeader final {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t shaderCount;
+    uint32_t reserved;
+};
+
+struct ArchiveEntry final {
+    uint64_t codeOffset;
+    uint64_t codeSize;
+    uint32_t nameOffset;
+    uint32_t nameSize;
+};
+
+static constexpr uint32_t ARCHIVE_MAGIC_NUMBER = 0x41565053; // "SPVA"
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+static constexpr uint32_t SPIRV_MAGIC_NUMBER = 0x07230203;
+
+static bool isInFile(uint64_t offset, uint64_t size, size_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+template <typename T>
+static T readRecord(std::span<const std::byte> bytes, size_t offset) {
+    auto record = T {};
+    std::memcpy(&record, bytes.data() + offset, sizeof(T));
+
+    return record;
+}
+
+template <typename T>
+static void writeRecord(std::ofstream& file, const T& record) {
+    file.write(reinterpret_cast<const char*>(&record), sizeof(T));
+}
+
+ShaderArchive::ShaderArchive(const std::filesystem::path& filePath)
+    : m_filePath { filePath }
+    , m_file { filePath }
+    , m_shaderNames {}
+    , m_shaders {}
+{
+    const auto bytes = m_file.getBytes();
+    if (bytes.size() < sizeof(ArchiveHeader)) {
+        throw std::runtime_error(fmt::format("shader archive `{}` is truncated!", filePath.string()));
+    }
+
+    const auto header = readRecord<ArchiveHeader>(bytes, 0);
+    if (header.magic != ARCHIVE_MAGIC_NUMBER) {
+        throw std::runtime_error(fmt::format("`{}` is not a shader archive!", filePath.string()));
+    }
+
+    if (header.version != ARCHIVE_VERSION) {
+        throw std::runtime_error(fmt::format(
+            "shader archive `{}` has version {}, expected version {}!",
+            filePath.string(), header.version, ARCHIVE_VERSION
+        ));
+    }
+
+    const uint64_t entryTableSize = static_cast<uint64_t>(header.shaderCount) * sizeof(ArchiveEntry);
+    if (!isInFile(sizeof(ArchiveHeader), entryTableSize, bytes.size())) {
+        throw std::runtime_error(fmt::format("shader archive `{}` is truncated!", filePath.string()));
+    }
+
+    m_shaderNames.reserve(header.shaderCount);
+    m_shaders.reserve(header.shaderCount);
+    for (uint32_t i = 0; i < header.shaderCount; i++) {
+        const auto entry = readRecord<ArchiveEntry>(bytes, sizeof(ArchiveHeader) + i * sizeof(ArchiveEntry));
+        if (!isInFile(entry.nameOffset, entry.nameSize, bytes.size()) || !isInFile(entry.codeOffset, entry.codeSize, bytes.size())) {
+            throw std::runtime_error(fmt::format("shader archive `{}` is truncated!", filePath.string()));
+        }
+
+        const auto name = std::string_view {
+            reinterpret_cast<const char*>(bytes.data() + entry.nameOffset),
+            entry.nameSize
+        };
+
+        // The code goes to Vulkan without being copied, so it has to be word aligned in the mapping.
+        if (entry.codeSize == 0 || entry.codeOffset % sizeof(uint32_t) != 0 || entry.codeSize % sizeof(uint32_t) != 0) {
+            throw std::runtime_error(fmt::format(
+                "shader `{}` in shader archive `{}` is not a whole number of aligned SPIR-V words!",
+                name, filePath.string()
+            ));
+        }
+
+        const auto code = std::span<const uint32_t> {
+            reinterpret_cast<const uint32_t*>(bytes.data() + entry.codeOffset),
+            static_cast<size_t>(entry.codeSize / sizeof(uint32_t))
+        };
+        if (code[0] != SPIRV_MAGIC_NUMBER) {
+            throw std::runtime_error(fmt::format("shader `{}` in shader archive `{}` is not SPIR-V!", name, filePath.string()));
+        }
+
+        if (!m_shaders.emplace(name, code).second) {
+            throw std::runtime_error(fmt::format("shader archive `{}` holds shader `{}` more than once!", filePath.string(), name));
+        }
+
+        m_shaderNames.push_back(name);
+    }
+}
+
+const std::filesystem::path& ShaderArchive::getFilePath() const {
+    return m_filePath;
+}
+
+std::span<const std::string_view> ShaderArchive::getShaderNames() const {
+    return m_shaderNames;
+}
+
+std::optional<std::span<const uint32_t>> ShaderArchive::findShader(std::string_view name) const {
+    const auto shader = m_shaders.find(name);
+    if (shader == m_shaders.end()) {
+        return std::nullopt;
+    }
+
+    return shader->second;
+}
+
+std::span<const uint32_t> ShaderArchive::getShader(std::string_view name) const {
+    const auto shader = this->findShader(name);
+    if (!shader.has_value()) {
+        throw std::runtime_error(fmt::format("shader archive `{}` has no shader `{}`!", m_filePath.string(), name));
+    }
+
+    return *shader;
+}
+
+void ShaderArchive::write(const std::filesystem::path& filePath, std::span<const Entry> entries) {
+    auto names = std::unordered_set<std::string_view> {};
+    for (const auto& entry : entries) {
+        if (entry.code.empty() || entry.code[0] != SPIRV_MAGIC_NUMBER) {
+            throw std::runtime_error(fmt::format("shader `{}` is not SPIR-V!", entry.name));
+        }
+
+        if (!names.insert(entry.name).second) {
+            throw std::runtime_error(fmt::format("shader `{}` was packed more than once!", entry.name));
+        }
+    }
+
+    // The names follow the entry table back to back, and the code starts on the first word boundary
+    // after them. Every module is a whole number of words, so each one after it stays aligned too.
+    auto archiveEntries = std::vector<ArchiveEntry> {};
+    archiveEntries.reserve(entries.size());
+
+    uint64_t nameOffset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (const auto& entry : entries) {
+        archiveEntries.push_back(ArchiveEntry {
+            .codeOffset = 0,
+            .codeSize = entry.code.size_bytes(),
+            .nameOffset = static_cast<uint32_t>(nameOffset),
+            .nameSize = static_cast<uint32_t>(entry.name.size()),
+        });
+        nameOffset += entry.name.size();
+    }
+
+    if (nameOffset > UINT32_MAX) {
+        throw std::runtime_error("shader names do not fit into a shader archive!");
+    }
+
+    const uint64_t codeStart = (nameOffset + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+    uint64_t codeOffset = codeStart;
+    for (auto& archiveEntry : archiveEntries) {
+        archiveEntry.codeOffset = codeOffset;
+        codeOffset += archiveEntry.codeSize;
+    }
+
+    VulkanEngine::writeFileAtomically(filePath, "shader archive", [&](std::ofstream& file) {
+        writeRecord(file, ArchiveHeader {
+            .magic = ARCHIVE_MAGIC_NUMBER,
+            .version = ARCHIVE_VERSION,
+            .shaderCount = static_cast<uint32_t>(entries.size()),
+            .reserved = 0,
+        });
+        for (const auto& archiveEntry : archiveEntries) {
+            writeRecord(file, archiveEntry);
+        }
+
+        for (const auto& entry : entries) {
+            file.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+        }
+
+        const auto padding = std::vector<char>(codeStart - nameOffset, '\0');
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+        for (const auto& entry : entries) {
+            file.write(reinterpret_cast<const char*>(entry.code.data()), static_cast<std::streamsize>(entry.code.size_bytes()));
+        }
+    });
+}
@@ -0,0 +1,56 @@
+#ifndef _SHADER_ARCHIVE_H
+#define _SHADER_ARCHIVE_H
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Many SPIR-V modules packed into one file, looked up by name. The archive is mapped into memory and
+// every module is stored on a word boundary, so the code it hands out points straight into the
+// mapping and can go to `vkCreateShaderModule` as is. The views stay valid for the lifetime of the
+// archive.
+class ShaderArchive final {
+    public:
+        struct Entry final {
+            std::string name;
+            std::span<const uint32_t> code;
+        };
+
+        explicit ShaderArchive(const std::filesystem::path& filePath);
+
+        ShaderArchive(const ShaderArchive&) = delete;
+        ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+        const std::filesystem::path& getFilePath() const;
+
+        // The names of the shaders in the order they were packed.
+        std::span<const std::string_view> getShaderNames() const;
+
+        std::optional<std::span<const uint32_t>> findShader(std::string_view name) const;
+
+        std::span<const uint32_t> getShader(std::string_view name) const;
+
+        // Packs `entries` into a new archive at `filePath`, replacing any archive already there. The archive
+        // is renamed into place once it is complete, so a running program that has the old archive mapped
+        // keeps reading the old one.
+        static void write(const std::filesystem::path& filePath, std::span<const Entry> entries);
+    private:
+        std::filesystem::path m_filePath;
+        MappedFile m_file;
+        std::vector<std::string_view> m_shaderNames;
+        std::unordered_map<std::string_view, std::span<const uint32_t>> m_shaders;
+};
+
+}
+
+#endif // _SHADER_ARCHIVE_H
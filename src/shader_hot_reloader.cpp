@@ -0,0 +1,208 @@
+#include "shader_hot_reloader.h"
+
+#include <array>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+
+using ShaderHotReloader = VulkanEngine::ShaderHotReloader;
+
+// How long the watcher blocks for file events before it checks whether it should stop.
+static constexpr int WATCH_POLL_TIMEOUT_MILLISECONDS = 100;
+
+ShaderHotReloader::ShaderHotReloader(const std::filesystem::path& shaderDirectory, Reload reload)
+    : m_shaderDirectory { shaderDirectory }
+    , m_outputDirectory { std::filesystem::temp_directory_path() / "shader_hot_reload" }
+    , m_reload { std::move(reload) }
+    , m_inotifyFileDescriptor { -1 }
+    , m_isStopping { false }
+    , m_thread {}
+{
+#ifdef __linux__
+    if (!std::filesystem::is_directory(m_shaderDirectory)) {
+        throw std::runtime_error(fmt::format("shader directory `{}` does not exist!", m_shaderDirectory.string()));
+    }
+
+    std::filesystem::create_directories(m_outputDirectory);
+
+    m_inotifyFileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFileDescriptor < 0) {
+        throw std::runtime_error("failed to initialize inotify!");
+    }
+
+    // Editors either write a file in place or write a new file and rename it over the old one.
+    const int watchDescriptor = inotify_add_watch(m_inotifyFileDescriptor, m_shaderDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchDescriptor < 0) {
+        close(m_inotifyFileDescriptor);
+
+        throw std::runtime_error(fmt::format("failed to watch shader directory `{}`!", m_shaderDirectory.string()));
+    }
+
+    m_thread = std::thread { [this]() { this->watch(); } };
+#else
+    throw std::runtime_error("shader hot reloading is only supported on Linux!");
+#endif
+}
+
+ShaderHotReloader::~ShaderHotReloader() {
+    m_isStopping.store(true);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+#ifdef __linux__
+    if (m_inotifyFileDescriptor >= 0) {
+        close(m_inotifyFileDescriptor);
+    }
+#endif
+}
+
+const std::filesystem::path& ShaderHotReloader::getShaderDirectory() const {
+    return m_shaderDirectory;
+}
+
+void ShaderHotReloader::watch() {
+#ifdef __linux__
+    alignas(inotify_event) auto buffer = std::array<char, 4096> {};
+    while (!m_isStopping.load()) {
+        auto pollInfo = pollfd {
+            .fd = m_inotifyFileDescriptor,
+            .events = POLLIN,
+            .revents = 0,
+        };
+        if (poll(&pollInfo, 1, WATCH_POLL_TIMEOUT_MILLISECONDS) <= 0) {
+            continue;
+        }
+
+        // A single save usually raises several events, so each batch recompiles every changed file once.
+        auto changedFileNames = std::set<std::string> {};
+        ssize_t readSize = 0;
+        while ((readSize = read(m_inotifyFileDescriptor, buffer.data(), buffer.size())) > 0) {
+            for (ssize_t offset = 0; offset < readSize;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                if (event->len > 0) {
+                    changedFileNames.emplace(event->name);
+                }
+
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+
+        for (const auto& fileName : changedFileNames) {
+            if (m_isStopping.load()) {
+                break;
+            }
+
+            this->reloadShader(m_shaderDirectory / fileName);
+        }
+    }
+#endif
+}
+
+void ShaderHotReloader::reloadShader(const std::filesystem::path& sourceFile) {
+    // Anything thrown here would end the program, so a broken shader is reported rather than rethrown.
+    try {
+        const auto spirvFile = this->compileShader(sourceFile);
+        if (!spirvFile.has_value()) {
+            return;
+        }
+
+        m_reload(sourceFile, *spirvFile);
+    } catch (const std::exception& exception) {
+        fmt::println(std::cerr, "Failed to reload shader `{}`: {}", sourceFile.filename().string(), exception.what());
+    }
+}
+
+std::optional<std::filesystem::path> ShaderHotReloader::compileShader(const std::filesystem::path& sourceFile) const {
+    auto spirvFile = m_outputDirectory / sourceFile.filename();
+    spirvFile += ".spv";
+
+    const auto compileCommand = ShaderHotReloader::getCompileCommand(sourceFile, spirvFile);
+    if (!compileCommand.has_value()) {
+        return std::nullopt;
+    }
+
+    if (!ShaderHotReloader::runCompiler(*compileCommand)) {
+        fmt::println(std::cerr, "Failed to compile shader `{}`, keeping the previous version", sourceFile.filename().string());
+
+        return std::nullopt;
+    }
+
+    return spirvFile;
+}
+
+bool ShaderHotReloader::runCompiler(const std::vector<std::string>& arguments) {
+#ifdef __linux__
+    // The compiler is started without a shell, so nothing in a file name is ever interpreted as a command.
+    auto argv = std::vector<char*> {};
+    for (const auto& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t processId = 0;
+    if (posix_spawnp(&processId, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+        fmt::println(std::cerr, "Failed to start `{}`", arguments[0]);
+
+        return false;
+    }
+
+    int status = 0;
+    while (waitpid(processId, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+    return false;
+#endif
+}
+
+std::optional<std::vector<std::string>> ShaderHotReloader::getCompileCommand(const std::filesystem::path& sourceFile, const std::filesystem::path& spirvFile) {
+    // The demo only runs GLSL shaders, so nothing else is worth compiling.
+    if (sourceFile.extension() != ".glsl") {
+        return std::nullopt;
+    }
+
+    const auto stage = sourceFile.stem().extension();
+    const auto shaderStage = [&]() -> std::optional<std::string> {
+        if (stage == ".vert") {
+            return "vertex";
+        } else if (stage == ".frag") {
+            return "fragment";
+        } else if (stage == ".comp") {
+            return "compute";
+        }
+
+        return std::nullopt;
+    }();
+    if (!shaderStage.has_value()) {
+        return std::nullopt;
+    }
+
+    return std::vector<std::string> {
+        "glslc",
+        fmt::format("-fshader-stage={}", *shaderStage),
+        "-o",
+        spirvFile.string(),
+        sourceFile.string(),
+    };
+}
@@ -0,0 +1,60 @@
+#ifndef _SHADER_HOT_RELOADER_H
+#define _SHADER_HOT_RELOADER_H
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Watches a directory of GLSL shader sources during development, and recompiles every source that is
+// saved into SPIR-V on a background thread. The stage of a source comes from its file name in the same
+// way as in the build, such as `shader_compute.comp.glsl`, and the sources are compiled with `glslc`
+// found on the `PATH`. Other files in the directory are ignored.
+//
+// `reload` is called on the background thread with the source and the freshly compiled SPIR-V file,
+// so it may take its time building pipelines without holding up the frames. A source that fails to
+// compile is reported and skipped, and whatever was built from the last good version stays in use.
+// Watching relies on inotify, so it is only supported on Linux.
+class ShaderHotReloader final {
+    public:
+        using Reload = std::function<void(const std::filesystem::path&, const std::filesystem::path&)>;
+
+        explicit ShaderHotReloader(const std::filesystem::path& shaderDirectory, Reload reload);
+
+        // Stops watching and waits for a reload still running, since it calls back into the caller.
+        ~ShaderHotReloader();
+
+        ShaderHotReloader(const ShaderHotReloader&) = delete;
+        ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+        const std::filesystem::path& getShaderDirectory() const;
+    private:
+        std::filesystem::path m_shaderDirectory;
+        std::filesystem::path m_outputDirectory;
+        Reload m_reload;
+        int m_inotifyFileDescriptor;
+        std::atomic<bool> m_isStopping;
+        std::thread m_thread;
+
+        void watch();
+
+        void reloadShader(const std::filesystem::path& sourceFile);
+
+        std::optional<std::filesystem::path> compileShader(const std::filesystem::path& sourceFile) const;
+
+        // The compiler and its arguments, or nothing when the file is not a GLSL shader source.
+        static std::optional<std::vector<std::string>> getCompileCommand(const std::filesystem::path& sourceFile, const std::filesystem::path& spirvFile);
+
+        // Runs the compiler and waits for it, returning whether it succeeded.
+        static bool runCompiler(const std::vector<std::string>& arguments);
+};
+
+}
+
+#endif // _SHADER_HOT_RELOADER_H
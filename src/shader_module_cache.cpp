@@ -0,0 +1,241 @@
+#include "shader_module_cache.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+
+using ShaderCodeLifetime = VulkanEngine::ShaderCodeLifetime;
+using ShaderModuleCache = VulkanEngine::ShaderModuleCache;
+using ShaderModuleCacheStats = VulkanEngine::ShaderModuleCacheStats;
+
+ShaderModuleCache::ShaderModuleCache(VkDevice device)
+    : ShaderModuleCache { device, ShaderModuleCache::UNLIMITED_UNUSED_MODULE_COUNT }
+{
+}
+
+ShaderModuleCache::ShaderModuleCache(VkDevice device, size_t maxUnusedModuleCount)
+    : m_device { device }
+    , m_maxUnusedModuleCount { maxUnusedModuleCount }
+    , m_entries {}
+    , m_hashes {}
+    , m_unusedModuleCount { 0 }
+    , m_releaseSequenceNumber { 0 }
+    , m_hitCount { 0 }
+    , m_missCount { 0 }
+    , m_evictionCount { 0 }
+{
+}
+
+ShaderModuleCache::~ShaderModuleCache() {
+    for (const auto& [hash, bucket] : m_entries) {
+        for (const auto& entry : bucket) {
+            vkDestroyShaderModule(m_device, entry.shaderModule, nullptr);
+        }
+    }
+
+    m_entries.clear();
+    m_hashes.clear();
+    m_device = VK_NULL_HANDLE;
+}
+
+VkShaderModule ShaderModuleCache::acquire(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    const uint64_t hash = ShaderModuleCache::hashCode(code);
+
+    {
+        auto lock = std::unique_lock<std::mutex> { m_mutex };
+        const auto entry = this->findEntry(hash, code);
+        if (entry != nullptr) {
+            m_hitCount++;
+
+            return this->acquireEntry(*entry);
+        }
+    }
+
+    // The module is created without holding the lock, so that threads building different pipelines do not
+    // wait on each other's shader compiles.
+    const auto shaderModule = this->createShaderModule(code);
+
+    auto lock = std::unique_lock<std::mutex> { m_mutex };
+
+    // Another thread may have created a module for the same code in the meantime, in which case everybody
+    // shares that one.
+    const auto entry = this->findEntry(hash, code);
+    if (entry != nullptr) {
+        vkDestroyShaderModule(m_device, shaderModule, nullptr);
+        m_hitCount++;
+
+        return this->acquireEntry(*entry);
+    }
+
+    auto newEntry = Entry {
+        .shaderModule = shaderModule,
+        .referenceCount = 1,
+    };
+    if (codeLifetime == ShaderCodeLifetime::Static) {
+        newEntry.staticCode = code;
+    } else {
+        newEntry.ownedCode.assign(code.begin(), code.end());
+    }
+
+    m_entries[hash].push_back(std::move(newEntry));
+    m_hashes.emplace(shaderModule, hash);
+    m_missCount++;
+
+    return shaderModule;
+}
+
+void ShaderModuleCache::release(VkShaderModule shaderModule) {
+    auto lock = std::unique_lock<std::mutex> { m_mutex };
+    const auto hash = m_hashes.find(shaderModule);
+    if (hash == m_hashes.end()) {
+        throw std::runtime_error("released a shader module that did not come from the shader module cache!");
+    }
+
+    auto& bucket = m_entries.at(hash->second);
+    const auto entry = std::ranges::find(bucket, shaderModule, &Entry::shaderModule);
+    if (entry->referenceCount == 0) {
+        throw std::runtime_error("released a shader module more often than it was acquired!");
+    }
+
+    entry->referenceCount--;
+    if (entry->referenceCount > 0) {
+        return;
+    }
+
+    entry->releaseSequenceNumber = m_releaseSequenceNumber++;
+    m_unusedModuleCount++;
+
+    while (m_unusedModuleCount > m_maxUnusedModuleCount) {
+        this->evictLeastRecentlyReleased();
+    }
+}
+
+void ShaderModuleCache::evictUnused() {
+    auto lock = std::unique_lock<std::mutex> { m_mutex };
+    while (m_unusedModuleCount > 0) {
+        this->evictLeastRecentlyReleased();
+    }
+}
+
+ShaderModuleCacheStats ShaderModuleCache::getStats() const {
+    auto lock = std::unique_lock<std::mutex> { m_mutex };
+
+    return ShaderModuleCacheStats {
+        .moduleCount = m_hashes.size(),
+        .unusedModuleCount = m_unusedModuleCount,
+        .hitCount = m_hitCount,
+        .missCount = m_missCount,
+        .evictionCount = m_evictionCount,
+    };
+}
+
+uint64_t ShaderModuleCache::hashCode(std::span<const uint32_t> code) {
+    // SPIR-V is a stream of 32-bit words, so the hash mixes in a whole word per multiply instead of a byte.
+    uint64_t hash = 0xCBF29CE484222325ull ^ (code.size() * 0x9E3779B97F4A7C15ull);
+    for (const uint32_t word : code) {
+        hash = (hash ^ word) * 0x100000001B3ull;
+        hash ^= hash >> 29;
+    }
+
+    // The MurmurHash3 finalizer spreads the last words over every bit of the result.
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+VkShaderModule ShaderModuleCache::createShaderModule(std::span<const uint32_t> code) {
+    const auto createInfo = VkShaderModuleCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .codeSize = code.size_bytes(),
+        .pCode = code.data(),
+    };
+
+    auto shaderModule = VkShaderModule {};
+    const auto result = vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    return shaderModule;
+}
+
+ShaderModuleCache::Entry* ShaderModuleCache::findEntry(uint64_t hash, std::span<const uint32_t> code) {
+    const auto bucket = m_entries.find(hash);
+    if (bucket == m_entries.end()) {
+        return nullptr;
+    }
+
+    const auto entry = std::ranges::find_if(bucket->second, [code](const Entry& entry) {
+        return std::ranges::equal(entry.getCode(), code);
+    });
+    if (entry == bucket->second.end()) {
+        return nullptr;
+    }
+
+    return &*entry;
+}
+
+VkShaderModule ShaderModuleCache::acquireEntry(Entry& entry) {
+    if (entry.referenceCount == 0) {
+        m_unusedModuleCount--;
+    }
+
+    entry.referenceCount++;
+
+    return entry.shaderModule;
+}
+
+std::span<const uint32_t> ShaderModuleCache::Entry::getCode() const {
+    if (!ownedCode.empty()) {
+        return ownedCode;
+    }
+
+    return staticCode;
+}
+
+void ShaderModuleCache::evictLeastRecentlyReleased() {
+    auto oldest = std::optional<std::pair<uint64_t, size_t>> {};
+    uint64_t oldestSequenceNumber = 0;
+    for (const auto& [hash, bucket] : m_entries) {
+        for (size_t i = 0; i < bucket.size(); i++) {
+            const auto& entry = bucket[i];
+            if (entry.referenceCount > 0) {
+                continue;
+            }
+
+            if (!oldest.has_value() || entry.releaseSequenceNumber < oldestSequenceNumber) {
+                oldest = std::make_pair(hash, i);
+                oldestSequenceNumber = entry.releaseSequenceNumber;
+            }
+        }
+    }
+
+    if (!oldest.has_value()) {
+        return;
+    }
+
+    this->destroyEntry(oldest->first, oldest->second);
+    m_unusedModuleCount--;
+    m_evictionCount++;
+}
+
+void ShaderModuleCache::destroyEntry(uint64_t hash, size_t entryIndex) {
+    auto& bucket = m_entries.at(hash);
+    const auto shaderModule = bucket[entryIndex].shaderModule;
+
+    vkDestroyShaderModule(m_device, shaderModule, nullptr);
+    m_hashes.erase(shaderModule);
+
+    bucket.erase(bucket.begin() + static_cast<std::ptrdiff_t>(entryIndex));
+    if (bucket.empty()) {
+        m_entries.erase(hash);
+    }
+}
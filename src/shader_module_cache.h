@@ -0,0 +1,107 @@
+#ifndef _SHADER_MODULE_CACHE_H
+#define _SHADER_MODULE_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// How long the SPIR-V code handed to a shader cache stays around, which decides whether the cache can
+// keep pointing at it to compare it against later code, or has to keep a copy of its own.
+enum class ShaderCodeLifetime {
+    // The code outlives the cache, like the embedded shaders and the mapping of a shader archive.
+    Static,
+    // The code goes away once the call returns, like a shader read from a file.
+    Transient,
+};
+
+struct ShaderModuleCacheStats final {
+    size_t moduleCount = 0;
+    // Modules nobody holds a reference to any more, which are kept around until they are evicted.
+    size_t unusedModuleCount = 0;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    uint64_t evictionCount = 0;
+};
+
+// Hands out one `VkShaderModule` per distinct SPIR-V binary. Modules are keyed by a hash of the SPIR-V
+// words, and the words themselves are compared on a hash match, so asking for the same code again is a
+// map lookup rather than another `vkCreateShaderModule`. The words are only copied when their lifetime
+// is transient, so embedded and archived shaders are never held twice.
+//
+// Every `acquire` takes a reference that `release` gives back. A module nobody references stays cached,
+// so that a pipeline created again later reuses it, until `evictUnused` destroys it, or until more than
+// `maxUnusedModuleCount` modules are unused and it is the one released longest ago. The cache is safe to
+// use from several threads at once, and creates modules without holding its lock, so threads asking for
+// different code do not wait on each other.
+class ShaderModuleCache final {
+    public:
+        static constexpr size_t UNLIMITED_UNUSED_MODULE_COUNT = std::numeric_limits<size_t>::max();
+
+        explicit ShaderModuleCache(VkDevice device);
+        explicit ShaderModuleCache(VkDevice device, size_t maxUnusedModuleCount);
+
+        ~ShaderModuleCache();
+
+        ShaderModuleCache(const ShaderModuleCache&) = delete;
+        ShaderModuleCache& operator=(const ShaderModuleCache&) = delete;
+
+        VkShaderModule acquire(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+
+        void release(VkShaderModule shaderModule);
+
+        // Destroys every module nobody references. Pipelines created from a module do not need it any more.
+        void evictUnused();
+
+        ShaderModuleCacheStats getStats() const;
+
+        static uint64_t hashCode(std::span<const uint32_t> code);
+    private:
+        struct Entry final {
+            // The caller's code when it outlives the cache, and empty otherwise.
+            std::span<const uint32_t> staticCode;
+            // A copy of the caller's code when it does not.
+            std::vector<uint32_t> ownedCode;
+            VkShaderModule shaderModule = VK_NULL_HANDLE;
+            uint32_t referenceCount = 0;
+            // Orders the unused entries by when they were last released.
+            uint64_t releaseSequenceNumber = 0;
+
+            std::span<const uint32_t> getCode() const;
+        };
+
+        VkDevice m_device;
+        size_t m_maxUnusedModuleCount;
+        mutable std::mutex m_mutex;
+        // Different code with the same hash shares a bucket.
+        std::unordered_map<uint64_t, std::vector<Entry>> m_entries;
+        std::unordered_map<VkShaderModule, uint64_t> m_hashes;
+        size_t m_unusedModuleCount;
+        uint64_t m_releaseSequenceNumber;
+        uint64_t m_hitCount;
+        uint64_t m_missCount;
+        uint64_t m_evictionCount;
+
+        VkShaderModule createShaderModule(std::span<const uint32_t> code);
+
+        // The entry holding exactly `code`, if any. Both of these need the lock.
+        Entry* findEntry(uint64_t hash, std::span<const uint32_t> code);
+
+        VkShaderModule acquireEntry(Entry& entry);
+
+        void evictLeastRecentlyReleased();
+
+        void destroyEntry(uint64_t hash, size_t entryIndex);
+};
+
+}
+
+#endif // _SHADER_MODULE_CACHE_H
@@ -0,0 +1,466 @@
+#include "shader_reflection.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/core.h>
+
+
+using ShaderCodeLifetime = VulkanEngine::ShaderCodeLifetime;
+using ShaderModuleCache = VulkanEngine::ShaderModuleCache;
+using ShaderReflection = VulkanEngine::ShaderReflection;
+using ShaderReflectionCache = VulkanEngine::ShaderReflectionCache;
+
+static constexpr uint32_t SPIRV_MAGIC_NUMBER = 0x07230203;
+static constexpr size_t SPIRV_HEADER_WORD_COUNT = 5;
+
+// The opcodes, decorations, and enumerants of the SPIR-V specification that reflection looks at.
+enum SpirvOp : uint32_t {
+    SpirvOpEntryPoint = 15,
+    SpirvOpTypeInt = 21,
+    SpirvOpTypeFloat = 22,
+    SpirvOpTypeVector = 23,
+    SpirvOpTypeMatrix = 24,
+    SpirvOpTypeImage = 25,
+    SpirvOpTypeSampler = 26,
+    SpirvOpTypeSampledImage = 27,
+    SpirvOpTypeArray = 28,
+    SpirvOpTypeRuntimeArray = 29,
+    SpirvOpTypeStruct = 30,
+    SpirvOpTypePointer = 32,
+    SpirvOpConstant = 43,
+    SpirvOpSpecConstant = 50,
+    SpirvOpVariable = 59,
+    SpirvOpDecorate = 71,
+    SpirvOpMemberDecorate = 72,
+};
+
+enum SpirvDecoration : uint32_t {
+    SpirvDecorationSpecId = 1,
+    SpirvDecorationBlock = 2,
+    SpirvDecorationBufferBlock = 3,
+    SpirvDecorationArrayStride = 6,
+    SpirvDecorationMatrixStride = 7,
+    SpirvDecorationBinding = 33,
+    SpirvDecorationDescriptorSet = 34,
+    SpirvDecorationOffset = 35,
+};
+
+enum SpirvStorageClass : uint32_t {
+    SpirvStorageClassUniformConstant = 0,
+    SpirvStorageClassUniform = 2,
+    SpirvStorageClassPushConstant = 9,
+    SpirvStorageClassStorageBuffer = 12,
+};
+
+static constexpr uint32_t SPIRV_DIM_BUFFER = 5;
+static constexpr uint32_t SPIRV_DIM_SUBPASS_DATA = 6;
+// The `Sampled` operand of an image type that is only ever read through a sampler.
+static constexpr uint32_t SPIRV_IMAGE_SAMPLED = 1;
+
+// The types, constants, variables, and decorations of a module, indexed by result id.
+struct ShaderReflection::SpirvModule final {
+    struct Instruction final {
+        uint32_t opcode = 0;
+        // The words following the result id.
+        std::vector<uint32_t> operands;
+    };
+
+    struct Variable final {
+        uint32_t pointerType = 0;
+        uint32_t storageClass = 0;
+    };
+
+    VkShaderStageFlags stageFlags = 0;
+    std::unordered_map<uint32_t, Instruction> types;
+    std::unordered_map<uint32_t, uint32_t> constants;
+    std::map<uint32_t, Variable> variables;
+    std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> decorations;
+    std::map<std::pair<uint32_t, uint32_t>, std::unordered_map<uint32_t, uint32_t>> memberDecorations;
+
+    explicit SpirvModule(std::span<const uint32_t> code) {
+        if (code.size() < SPIRV_HEADER_WORD_COUNT || code[0] != SPIRV_MAGIC_NUMBER) {
+            throw std::runtime_error("shader code is not a SPIR-V module!");
+        }
+
+        for (size_t offset = SPIRV_HEADER_WORD_COUNT; offset < code.size();) {
+            const uint32_t wordCount = code[offset] >> 16;
+            const uint32_t opcode = code[offset] & 0xFFFF;
+            if (wordCount == 0 || offset + wordCount > code.size()) {
+                throw std::runtime_error("SPIR-V module has a truncated instruction!");
+            }
+
+            this->addInstruction(opcode, code.subspan(offset + 1, wordCount - 1));
+            offset += wordCount;
+        }
+    }
+
+    void addInstruction(uint32_t opcode, std::span<const uint32_t> words) {
+        switch (opcode) {
+            case SpirvOpEntryPoint:
+                stageFlags |= SpirvModule::getStageFlags(words[0]);
+                break;
+            case SpirvOpTypeInt:
+            case SpirvOpTypeFloat:
+            case SpirvOpTypeVector:
+            case SpirvOpTypeMatrix:
+            case SpirvOpTypeImage:
+            case SpirvOpTypeSampler:
+            case SpirvOpTypeSampledImage:
+            case SpirvOpTypeArray:
+            case SpirvOpTypeRuntimeArray:
+            case SpirvOpTypeStruct:
+            case SpirvOpTypePointer:
+                types.insert_or_assign(words[0], Instruction {
+                    .opcode = opcode,
+                    .operands = std::vector<uint32_t>(words.begin() + 1, words.end()),
+                });
+                break;
+            case SpirvOpConstant:
+            case SpirvOpSpecConstant:
+                // Only the low word matters, since constants are only read as array lengths.
+                constants.insert_or_assign(words[1], words[2]);
+                break;
+            case SpirvOpVariable:
+                variables.insert_or_assign(words[1], Variable {
+                    .pointerType = words[0],
+                    .storageClass = words[2],
+                });
+                break;
+            case SpirvOpDecorate:
+                decorations[words[0]][words[1]] = (words.size() > 2) ? words[2] : 0;
+                break;
+            case SpirvOpMemberDecorate:
+                memberDecorations[std::make_pair(words[0], words[1])][words[2]] = (words.size() > 3) ? words[3] : 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    static VkShaderStageFlags getStageFlags(uint32_t executionModel) {
+        switch (executionModel) {
+            case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+            case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        throw std::runtime_error(fmt::format("SPIR-V module has an unsupported execution model {}!", executionModel));
+    }
+
+    const Instruction& getType(uint32_t typeId) const {
+        const auto type = types.find(typeId);
+        if (type == types.end()) {
+            throw std::runtime_error(fmt::format("SPIR-V module uses undeclared type %{}!", typeId));
+        }
+
+        return type->second;
+    }
+
+    std::optional<uint32_t> getDecoration(uint32_t id, uint32_t decoration) const {
+        const auto idDecorations = decorations.find(id);
+        if (idDecorations == decorations.end()) {
+            return std::nullopt;
+        }
+
+        const auto value = idDecorations->second.find(decoration);
+        if (value == idDecorations->second.end()) {
+            return std::nullopt;
+        }
+
+        return value->second;
+    }
+
+    std::optional<uint32_t> getMemberDecoration(uint32_t structType, uint32_t member, uint32_t decoration) const {
+        const auto structMemberDecorations = memberDecorations.find(std::make_pair(structType, member));
+        if (structMemberDecorations == memberDecorations.end()) {
+            return std::nullopt;
+        }
+
+        const auto value = structMemberDecorations->second.find(decoration);
+        if (value == structMemberDecorations->second.end()) {
+            return std::nullopt;
+        }
+
+        return value->second;
+    }
+
+    uint32_t getArrayLength(const Instruction& arrayType) const {
+        const auto length = constants.find(arrayType.operands[1]);
+        if (length == constants.end()) {
+            throw std::runtime_error("SPIR-V module has an array whose length is not a constant!");
+        }
+
+        return length->second;
+    }
+
+    VkDescriptorType getDescriptorType(uint32_t storageClass, uint32_t typeId) const {
+        const auto& type = this->getType(typeId);
+        switch (storageClass) {
+            case SpirvStorageClassStorageBuffer:
+                return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            case SpirvStorageClassUniform:
+                // Before SPIR-V 1.3, storage buffers were uniform blocks decorated as buffer blocks.
+                if (this->getDecoration(typeId, SpirvDecorationBufferBlock).has_value()) {
+                    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                }
+
+                return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            case SpirvStorageClassUniformConstant:
+                if (type.opcode == SpirvOpTypeSampler) {
+                    return VK_DESCRIPTOR_TYPE_SAMPLER;
+                } else if (type.opcode == SpirvOpTypeSampledImage) {
+                    return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                } else if (type.opcode == SpirvOpTypeImage) {
+                    const uint32_t dim = type.operands[1];
+                    const bool isSampled = type.operands[5] == SPIRV_IMAGE_SAMPLED;
+                    if (dim == SPIRV_DIM_SUBPASS_DATA) {
+                        return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                    } else if (dim == SPIRV_DIM_BUFFER) {
+                        return isSampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+                    }
+
+                    return isSampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                }
+                break;
+        }
+
+        throw std::runtime_error(fmt::format("SPIR-V module has a resource %{} of an unsupported type!", typeId));
+    }
+
+    // The size of a type in an explicitly laid out block, such as a push constant block.
+    uint32_t getSize(uint32_t typeId, std::optional<uint32_t> matrixStride) const {
+        const auto& type = this->getType(typeId);
+        switch (type.opcode) {
+            case SpirvOpTypeInt:
+            case SpirvOpTypeFloat:
+                return type.operands[0] / 8;
+            case SpirvOpTypeVector:
+                return type.operands[1] * this->getSize(type.operands[0], std::nullopt);
+            case SpirvOpTypeMatrix:
+                return type.operands[1] * matrixStride.value_or(this->getSize(type.operands[0], std::nullopt));
+            case SpirvOpTypeArray: {
+                const uint32_t stride = this->getDecoration(typeId, SpirvDecorationArrayStride)
+                    .value_or(this->getSize(type.operands[0], matrixStride));
+
+                return this->getArrayLength(type) * stride;
+            }
+            case SpirvOpTypeRuntimeArray:
+                return 0;
+            case SpirvOpTypeStruct: {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member < type.operands.size(); member++) {
+                    const uint32_t memberOffset = this->getMemberDecoration(typeId, member, SpirvDecorationOffset).value_or(0);
+                    const auto memberMatrixStride = this->getMemberDecoration(typeId, member, SpirvDecorationMatrixStride);
+                    size = std::max(size, memberOffset + this->getSize(type.operands[member], memberMatrixStride));
+                }
+
+                return size;
+            }
+        }
+
+        throw std::runtime_error(fmt::format("SPIR-V module has a block member %{} of an unsupported type!", typeId));
+    }
+};
+
+ShaderReflection::ShaderReflection(std::span<const uint32_t> code)
+    : m_stageFlags { 0 }
+    , m_descriptorSetLayoutBindings {}
+    , m_pushConstantRanges {}
+    , m_specializationConstantIds {}
+{
+    const auto spirvModule = SpirvModule { code };
+    m_stageFlags = spirvModule.stageFlags;
+
+    for (const auto& [variableId, variable] : spirvModule.variables) {
+        const auto& pointerType = spirvModule.getType(variable.pointerType);
+        uint32_t typeId = pointerType.operands[1];
+
+        if (variable.storageClass == SpirvStorageClassPushConstant) {
+            const auto& blockType = spirvModule.getType(typeId);
+            if (blockType.operands.empty()) {
+                continue;
+            }
+
+            // The range starts at the first member, so blocks that leave room for other stages' ranges line up.
+            uint32_t offset = std::numeric_limits<uint32_t>::max();
+            for (uint32_t member = 0; member < blockType.operands.size(); member++) {
+                offset = std::min(offset, spirvModule.getMemberDecoration(typeId, member, SpirvDecorationOffset).value_or(0));
+            }
+
+            m_pushConstantRanges.push_back(VkPushConstantRange {
+                .stageFlags = m_stageFlags,
+                .offset = offset,
+                .size = spirvModule.getSize(typeId, std::nullopt) - offset,
+            });
+
+            continue;
+        }
+
+        const auto set = spirvModule.getDecoration(variableId, SpirvDecorationDescriptorSet);
+        const auto binding = spirvModule.getDecoration(variableId, SpirvDecorationBinding);
+        if (!set.has_value() || !binding.has_value()) {
+            continue;
+        }
+
+        // An array of resources takes one descriptor per element.
+        uint32_t descriptorCount = 1;
+        const auto& type = spirvModule.getType(typeId);
+        if (type.opcode == SpirvOpTypeArray) {
+            descriptorCount = spirvModule.getArrayLength(type);
+            typeId = type.operands[0];
+        } else if (type.opcode == SpirvOpTypeRuntimeArray) {
+            throw std::runtime_error("SPIR-V module has an unsized descriptor array, which reflection does not support!");
+        }
+
+        m_descriptorSetLayoutBindings[*set].push_back(VkDescriptorSetLayoutBinding {
+            .binding = *binding,
+            .descriptorType = spirvModule.getDescriptorType(variable.storageClass, typeId),
+            .descriptorCount = descriptorCount,
+            .stageFlags = m_stageFlags,
+            .pImmutableSamplers = nullptr,
+        });
+    }
+
+    for (auto& [set, bindings] : m_descriptorSetLayoutBindings) {
+        std::ranges::sort(bindings, {}, &VkDescriptorSetLayoutBinding::binding);
+    }
+
+    for (const auto& [id, idDecorations] : spirvModule.decorations) {
+        const auto specId = idDecorations.find(SpirvDecorationSpecId);
+        if (specId != idDecorations.end()) {
+            m_specializationConstantIds.push_back(specId->second);
+        }
+    }
+
+    std::ranges::sort(m_specializationConstantIds);
+}
+
+VkShaderStageFlags ShaderReflection::getStageFlags() const {
+    return m_stageFlags;
+}
+
+std::vector<uint32_t> ShaderReflection::getDescriptorSetNumbers() const {
+    auto setNumbers = std::vector<uint32_t> {};
+    for (const auto& [set, bindings] : m_descriptorSetLayoutBindings) {
+        setNumbers.push_back(set);
+    }
+
+    return setNumbers;
+}
+
+std::span<const VkDescriptorSetLayoutBinding> ShaderReflection::getDescriptorSetLayoutBindings(uint32_t set) const {
+    const auto bindings = m_descriptorSetLayoutBindings.find(set);
+    if (bindings == m_descriptorSetLayoutBindings.end()) {
+        return {};
+    }
+
+    return bindings->second;
+}
+
+std::span<const VkPushConstantRange> ShaderReflection::getPushConstantRanges() const {
+    return m_pushConstantRanges;
+}
+
+std::span<const uint32_t> ShaderReflection::getSpecializationConstantIds() const {
+    return m_specializationConstantIds;
+}
+
+std::vector<VkDescriptorPoolSize> ShaderReflection::getDescriptorPoolSizes(uint32_t set, uint32_t setCount) const {
+    auto poolSizes = std::vector<VkDescriptorPoolSize> {};
+    for (const auto& binding : this->getDescriptorSetLayoutBindings(set)) {
+        const auto poolSize = std::ranges::find(poolSizes, binding.descriptorType, &VkDescriptorPoolSize::type);
+        if (poolSize != poolSizes.end()) {
+            poolSize->descriptorCount += binding.descriptorCount * setCount;
+        } else {
+            poolSizes.push_back(VkDescriptorPoolSize {
+                .type = binding.descriptorType,
+                .descriptorCount = binding.descriptorCount * setCount,
+            });
+        }
+    }
+
+    return poolSizes;
+}
+
+bool ShaderReflection::hasSameInterface(const ShaderReflection& other) const {
+    const auto isSameBinding = [](const VkDescriptorSetLayoutBinding& binding, const VkDescriptorSetLayoutBinding& otherBinding) {
+        return binding.binding == otherBinding.binding
+            && binding.descriptorType == otherBinding.descriptorType
+            && binding.descriptorCount == otherBinding.descriptorCount
+            && binding.stageFlags == otherBinding.stageFlags;
+    };
+    const auto isSameRange = [](const VkPushConstantRange& range, const VkPushConstantRange& otherRange) {
+        return range.stageFlags == otherRange.stageFlags && range.offset == otherRange.offset && range.size == otherRange.size;
+    };
+
+    if (m_stageFlags != other.m_stageFlags || m_specializationConstantIds != other.m_specializationConstantIds) {
+        return false;
+    }
+
+    if (!std::ranges::equal(m_pushConstantRanges, other.m_pushConstantRanges, isSameRange)) {
+        return false;
+    }
+
+    // A set is only listed when it has bindings, so the same sets with the same bindings is the same layout.
+    if (this->getDescriptorSetNumbers() != other.getDescriptorSetNumbers()) {
+        return false;
+    }
+
+    for (const auto& [set, bindings] : m_descriptorSetLayoutBindings) {
+        if (!std::ranges::equal(bindings, other.getDescriptorSetLayoutBindings(set), isSameBinding)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ShaderReflectionCache::ShaderReflectionCache()
+    : m_reflections {}
+{
+}
+
+const ShaderReflection& ShaderReflectionCache::reflect(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime) {
+    const uint64_t hash = ShaderModuleCache::hashCode(code);
+
+    auto lock = std::unique_lock<std::mutex> { m_mutex };
+    const auto bucket = m_reflections.find(hash);
+    if (bucket != m_reflections.end()) {
+        const auto entry = std::ranges::find_if(bucket->second, [code](const Entry& entry) {
+            return std::ranges::equal(entry.getCode(), code);
+        });
+        if (entry != bucket->second.end()) {
+            return *entry->reflection;
+        }
+    }
+
+    // Reflected before the entry goes in, so a module that fails to parse leaves nothing behind.
+    auto newEntry = Entry {
+        .reflection = std::make_unique<const ShaderReflection>(code),
+    };
+    if (codeLifetime == ShaderCodeLifetime::Static) {
+        newEntry.staticCode = code;
+    } else {
+        newEntry.ownedCode.assign(code.begin(), code.end());
+    }
+
+    const auto& result = *newEntry.reflection;
+    m_reflections[hash].push_back(std::move(newEntry));
+
+    return result;
+}
+
+std::span<const uint32_t> ShaderReflectionCache::Entry::getCode() const {
+    if (!ownedCode.empty()) {
+        return ownedCode;
+    }
+
+    return staticCode;
+}
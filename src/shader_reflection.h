@@ -0,0 +1,88 @@
+#ifndef _SHADER_REFLECTION_H
+#define _SHADER_REFLECTION_H
+
+#include <vulkan/vulkan.h>
+
+#include "shader_module_cache.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// The resource interface of a SPIR-V module, read straight from the module's declarations. Every
+// variable with a `DescriptorSet` and `Binding` decoration becomes a binding of its set, with the
+// descriptor type following from its storage class and type, and every push constant block becomes
+// a push constant range. This is what the pipeline layout of a shader has to match, so the layouts
+// are built from it rather than kept in sync with the shader sources by hand.
+class ShaderReflection final {
+    public:
+        explicit ShaderReflection(std::span<const uint32_t> code);
+
+        VkShaderStageFlags getStageFlags() const;
+
+        // The numbers of the descriptor sets the shader uses, in ascending order.
+        std::vector<uint32_t> getDescriptorSetNumbers() const;
+
+        // The bindings of descriptor set `set` in ascending order, which is empty when the shader does not use
+        // the set.
+        std::span<const VkDescriptorSetLayoutBinding> getDescriptorSetLayoutBindings(uint32_t set) const;
+
+        std::span<const VkPushConstantRange> getPushConstantRanges() const;
+
+        // The ids of the shader's specialization constants in ascending order.
+        std::span<const uint32_t> getSpecializationConstantIds() const;
+
+        // The descriptors a pool needs to allocate `setCount` sets with the layout of descriptor set `set`.
+        std::vector<VkDescriptorPoolSize> getDescriptorPoolSizes(uint32_t set, uint32_t setCount) const;
+
+        // Whether the other shader has the same bindings, push constants, and specialization constants, so
+        // that a pipeline layout and specialization built for one of them fit the other as well.
+        bool hasSameInterface(const ShaderReflection& other) const;
+    private:
+        struct SpirvModule;
+
+        VkShaderStageFlags m_stageFlags;
+        std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> m_descriptorSetLayoutBindings;
+        std::vector<VkPushConstantRange> m_pushConstantRanges;
+        std::vector<uint32_t> m_specializationConstantIds;
+};
+
+// Reflects every distinct SPIR-V binary once, so the layouts of a shader can be asked for wherever they
+// are needed. Like the shader module cache, reflections are keyed by a hash of the SPIR-V words, the
+// words themselves are compared on a hash match, and only code with a transient lifetime is copied.
+// Reflections are never dropped, so the references handed out stay valid for the lifetime of the cache.
+// The cache is safe to use from several threads at once.
+class ShaderReflectionCache final {
+    public:
+        explicit ShaderReflectionCache();
+
+        ShaderReflectionCache(const ShaderReflectionCache&) = delete;
+        ShaderReflectionCache& operator=(const ShaderReflectionCache&) = delete;
+
+        const ShaderReflection& reflect(std::span<const uint32_t> code, ShaderCodeLifetime codeLifetime);
+    private:
+        struct Entry final {
+            // The caller's code when it outlives the cache, and empty otherwise.
+            std::span<const uint32_t> staticCode;
+            // A copy of the caller's code when it does not.
+            std::vector<uint32_t> ownedCode;
+            std::unique_ptr<const ShaderReflection> reflection;
+
+            std::span<const uint32_t> getCode() const;
+        };
+
+        std::mutex m_mutex;
+        // Different code with the same hash shares a bucket.
+        std::unordered_map<uint64_t, std::vector<Entry>> m_reflections;
+};
+
+}
+
+#endif // _SHADER_REFLECTION_H
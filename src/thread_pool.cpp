@@ -0,0 +1,161 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    // The calling thread of `parallelFor` takes part in the work, so it gets a queue of its own.
+    const size_t workerCount = std::max<size_t>(threadCount, 1) - 1;
+    for (size_t i = 0; i < workerCount + 1; i++) {
+        m_workQueues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (size_t i = 0; i < workerCount; i++) {
+        m_workers.emplace_back([this, i]() { this->workerLoop(i + 1); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        auto lock = std::unique_lock<std::mutex> { m_mutex };
+        m_stop = true;
+    }
+
+    m_workAvailable.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return m_workQueues.size();
+}
+
+size_t ThreadPool::getDefaultThreadCount() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    auto batch = Batch {};
+    batch.task = &task;
+    batch.remainingChunkCount = chunkCount;
+
+    {
+        // Count the chunks before queueing them, so a worker never sees more chunks than are counted.
+        // Publishing the count under the pool mutex guarantees that a worker going to sleep sees it.
+        auto lock = std::unique_lock<std::mutex> { m_mutex };
+        m_queuedChunkCount += chunkCount;
+    }
+
+    // Deal the chunks out round-robin, so every worker starts on its own queue and only steals once
+    // it runs out.
+    for (size_t i = 0; i < chunkCount; i++) {
+        const auto chunk = Chunk {
+            .begin = i * chunkSize,
+            .end = std::min(count, (i + 1) * chunkSize),
+            .batch = &batch,
+        };
+        auto& workQueue = *m_workQueues[i % m_workQueues.size()];
+        auto lock = std::unique_lock<std::mutex> { workQueue.mutex };
+        workQueue.chunks.push_back(chunk);
+    }
+
+    m_workAvailable.notify_all();
+
+    while (batch.remainingChunkCount > 0) {
+        auto chunk = this->popChunk(0);
+        if (!chunk.has_value()) {
+            chunk = this->stealChunk(0);
+        }
+
+        if (chunk.has_value()) {
+            this->runChunk(*chunk);
+        } else {
+            // Every remaining chunk of this batch is already running on a worker.
+            auto lock = std::unique_lock<std::mutex> { m_mutex };
+            m_batchFinished.wait(lock, [&batch]() { return batch.remainingChunkCount == 0; });
+        }
+    }
+
+    if (batch.exception) {
+        std::rethrow_exception(batch.exception);
+    }
+}
+
+void ThreadPool::workerLoop(size_t workerIndex) {
+    while (true) {
+        auto chunk = this->popChunk(workerIndex);
+        if (!chunk.has_value()) {
+            chunk = this->stealChunk(workerIndex);
+        }
+
+        if (chunk.has_value()) {
+            this->runChunk(*chunk);
+            continue;
+        }
+
+        auto lock = std::unique_lock<std::mutex> { m_mutex };
+        m_workAvailable.wait(lock, [this]() { return m_stop || m_queuedChunkCount > 0; });
+        if (m_stop && m_queuedChunkCount == 0) {
+            return;
+        }
+    }
+}
+
+std::optional<ThreadPool::Chunk> ThreadPool::popChunk(size_t workerIndex) {
+    auto& workQueue = *m_workQueues[workerIndex];
+    auto lock = std::unique_lock<std::mutex> { workQueue.mutex };
+    if (workQueue.chunks.empty()) {
+        return std::nullopt;
+    }
+
+    const auto chunk = workQueue.chunks.back();
+    workQueue.chunks.pop_back();
+    m_queuedChunkCount--;
+
+    return chunk;
+}
+
+std::optional<ThreadPool::Chunk> ThreadPool::stealChunk(size_t workerIndex) {
+    for (size_t i = 1; i < m_workQueues.size(); i++) {
+        auto& workQueue = *m_workQueues[(workerIndex + i) % m_workQueues.size()];
+        auto lock = std::unique_lock<std::mutex> { workQueue.mutex };
+        if (workQueue.chunks.empty()) {
+            continue;
+        }
+
+        const auto chunk = workQueue.chunks.front();
+        workQueue.chunks.pop_front();
+        m_queuedChunkCount--;
+
+        return chunk;
+    }
+
+    return std::nullopt;
+}
+
+void ThreadPool::runChunk(const Chunk& chunk) {
+    auto& batch = *chunk.batch;
+    try {
+        (*batch.task)(chunk.begin, chunk.end);
+    } catch (...) {
+        auto lock = std::unique_lock<std::mutex> { batch.exceptionMutex };
+        if (!batch.exception) {
+            batch.exception = std::current_exception();
+        }
+    }
+
+    if (batch.remainingChunkCount.fetch_sub(1) == 1) {
+        // Take the pool mutex so the notification cannot slip in between the caller checking the
+        // count and going to sleep.
+        auto lock = std::unique_lock<std::mutex> { m_mutex };
+        m_batchFinished.notify_all();
+    }
+}
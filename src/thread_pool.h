@@ -0,0 +1,69 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+// A fixed-size pool of worker threads with one task queue per worker. Each worker pops tasks
+// from the back of its own queue, and when that runs dry, steals from the front of the other
+// workers' queues, so uneven chunks still keep every core busy.
+class ThreadPool final {
+    public:
+        explicit ThreadPool(size_t threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadCount() const;
+
+        // Splits `[0, count)` into chunks of `chunkSize` elements and runs `task(begin, end)` on
+        // each chunk. The calling thread works on chunks too, and returns once every chunk is done.
+        // The first exception thrown by a chunk is rethrown on the calling thread.
+        void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& task);
+
+        static size_t getDefaultThreadCount();
+    private:
+        struct Batch final {
+            const std::function<void(size_t, size_t)>* task = nullptr;
+            std::atomic<size_t> remainingChunkCount = 0;
+            std::mutex exceptionMutex;
+            std::exception_ptr exception;
+        };
+
+        struct Chunk final {
+            size_t begin = 0;
+            size_t end = 0;
+            Batch* batch = nullptr;
+        };
+
+        struct WorkQueue final {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> m_workQueues;
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_batchFinished;
+        std::atomic<size_t> m_queuedChunkCount = 0;
+        bool m_stop = false;
+
+        void workerLoop(size_t workerIndex);
+        std::optional<Chunk> popChunk(size_t workerIndex);
+        std::optional<Chunk> stealChunk(size_t workerIndex);
+        void runChunk(const Chunk& chunk);
+};
+
+#endif // _THREAD_POOL_H
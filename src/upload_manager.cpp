@@ -0,0 +1,293 @@
+#include "upload_manager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+
+using UploadManager = VulkanEngine::UploadManager;
+using UploadTicket = VulkanEngine::UploadTicket;
+
+UploadManager::UploadManager(Engine& engine)
+    : UploadManager { engine, UploadManager::DEFAULT_RING_SIZE }
+{
+}
+
+UploadManager::UploadManager(Engine& engine, VkDeviceSize ringSize)
+    : m_engine { engine }
+    , m_queue { engine.getTransferQueue() }
+    , m_commandPool { engine.getTransferCommandPool() }
+    , m_isDedicatedTransferQueue { engine.getQueueFamilyIndices().hasDedicatedTransferFamily() }
+    , m_ringSize { ringSize }
+    , m_stagingBuffer { VK_NULL_HANDLE }
+    , m_stagingBufferMemory {}
+    , m_ringHead { 0 }
+    , m_ringTail { 0 }
+    , m_submittedBatches {}
+    , m_freeBatches {}
+    , m_recordingBatch {}
+    , m_isRecording { false }
+    , m_nextTicket { 1 }
+    , m_completedTicket { 0 }
+{
+    if (ringSize < UploadManager::COPY_ALIGNMENT) {
+        throw std::runtime_error("the upload ring buffer is too small!");
+    }
+
+    const auto bufferInfo = VkBufferCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = ringSize,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    auto stagingBuffer = VkBuffer {};
+    const auto resultCreateBuffer = vkCreateBuffer(m_engine.getLogicalDevice(), &bufferInfo, nullptr, &stagingBuffer);
+    if (resultCreateBuffer != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload ring buffer!");
+    }
+
+    auto memRequirements = VkMemoryRequirements {};
+    vkGetBufferMemoryRequirements(m_engine.getLogicalDevice(), stagingBuffer, &memRequirements);
+
+    const auto stagingBufferMemory = m_engine.allocateMemory(
+        memRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    vkBindBufferMemory(m_engine.getLogicalDevice(), stagingBuffer, stagingBufferMemory.memory, stagingBufferMemory.offset);
+
+    m_stagingBuffer = stagingBuffer;
+    m_stagingBufferMemory = stagingBufferMemory;
+}
+
+UploadManager::~UploadManager() {
+    if (m_isRecording) {
+        // Nothing was submitted, so the command buffer can go straight back to the pool.
+        vkEndCommandBuffer(m_recordingBatch.commandBuffer);
+        m_freeBatches.push_back(m_recordingBatch);
+        m_isRecording = false;
+    }
+
+    this->waitIdle();
+
+    for (const auto& batch : m_freeBatches) {
+        vkDestroyFence(m_engine.getLogicalDevice(), batch.fence, nullptr);
+        vkFreeCommandBuffers(m_engine.getLogicalDevice(), m_commandPool, 1, &batch.commandBuffer);
+    }
+
+    vkDestroyBuffer(m_engine.getLogicalDevice(), m_stagingBuffer, nullptr);
+    m_engine.freeMemory(m_stagingBufferMemory);
+
+    m_freeBatches.clear();
+    m_stagingBuffer = VK_NULL_HANDLE;
+}
+
+void UploadManager::upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    // Stream uploads larger than half the ring in pieces, so that one piece can be copied in while the
+    // batch reading the previous one is still in flight.
+    const VkDeviceSize maxPieceSize = std::max(m_ringSize / 2, UploadManager::COPY_ALIGNMENT);
+    const auto* bytes = static_cast<const char*>(data);
+
+    VkDeviceSize uploadedSize = 0;
+    while (uploadedSize < size) {
+        const VkDeviceSize pieceSize = std::min(size - uploadedSize, maxPieceSize);
+        const VkDeviceSize ringOffset = this->allocateRingRegion(pieceSize);
+
+        memcpy(static_cast<char*>(m_stagingBufferMemory.mappedData) + ringOffset, bytes + uploadedSize, static_cast<size_t>(pieceSize));
+
+        this->beginRecording();
+
+        const auto copyRegion = VkBufferCopy {
+            .srcOffset = ringOffset,
+            .dstOffset = dstOffset + uploadedSize,
+            .size = pieceSize,
+        };
+        vkCmdCopyBuffer(m_recordingBatch.commandBuffer, m_stagingBuffer, dstBuffer, 1, &copyRegion);
+
+        uploadedSize += pieceSize;
+    }
+}
+
+UploadTicket UploadManager::flush() {
+    if (!m_isRecording) {
+        // Everything uploaded so far is covered by the last ticket handed out.
+        return m_nextTicket - 1;
+    }
+
+    // A transfer-only queue supports neither the compute shader nor the vertex input stage in a barrier.
+    if (!m_isDedicatedTransferQueue) {
+        const auto barrier = VkMemoryBarrier {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        };
+        vkCmdPipelineBarrier(
+            m_recordingBatch.commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    vkEndCommandBuffer(m_recordingBatch.commandBuffer);
+
+    const auto submitInfo = VkSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &m_recordingBatch.commandBuffer,
+    };
+
+    const auto result = vkQueueSubmit(m_queue, 1, &submitInfo, m_recordingBatch.fence);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit upload command buffer!");
+    }
+
+    m_recordingBatch.ticket = m_nextTicket++;
+    m_recordingBatch.ringEnd = m_ringHead;
+    m_submittedBatches.push_back(m_recordingBatch);
+    m_isRecording = false;
+
+    return m_recordingBatch.ticket;
+}
+
+bool UploadManager::isComplete(UploadTicket ticket) {
+    this->retireCompletedBatches();
+
+    return ticket <= m_completedTicket;
+}
+
+void UploadManager::wait(UploadTicket ticket) {
+    while (m_completedTicket < ticket && !m_submittedBatches.empty()) {
+        this->retireOldestBatch();
+    }
+}
+
+void UploadManager::waitIdle() {
+    this->wait(std::numeric_limits<UploadTicket>::max());
+}
+
+VkDeviceSize UploadManager::getRingSize() const {
+    return m_ringSize;
+}
+
+VkDeviceSize UploadManager::allocateRingRegion(VkDeviceSize size) {
+    const VkDeviceSize alignedSize = ((size + UploadManager::COPY_ALIGNMENT - 1) / UploadManager::COPY_ALIGNMENT) * UploadManager::COPY_ALIGNMENT;
+    if (alignedSize > m_ringSize) {
+        throw std::runtime_error("upload does not fit into the upload ring buffer!");
+    }
+
+    // A region never wraps around the end of the ring. When it does not fit in front of the end, the
+    // bytes up to the end are skipped, and released again along with the region.
+    uint64_t start = m_ringHead;
+    if ((start % m_ringSize) + alignedSize > m_ringSize) {
+        start += m_ringSize - (start % m_ringSize);
+    }
+
+    this->retireCompletedBatches();
+    while (start + alignedSize - m_ringTail > m_ringSize) {
+        if (m_submittedBatches.empty()) {
+            if (!m_isRecording) {
+                // Nothing reads from the ring any more, so the region is free to start anywhere.
+                m_ringTail = start;
+                break;
+            }
+
+            // The ring is full of copies that have not been submitted yet.
+            this->flush();
+        }
+
+        this->retireOldestBatch();
+    }
+
+    m_ringHead = start + alignedSize;
+
+    return static_cast<VkDeviceSize>(start % m_ringSize);
+}
+
+void UploadManager::beginRecording() {
+    if (m_isRecording) {
+        return;
+    }
+
+    m_recordingBatch = this->acquireBatch();
+
+    const auto beginInfo = VkCommandBufferBeginInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    const auto result = vkBeginCommandBuffer(m_recordingBatch.commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+    }
+
+    m_isRecording = true;
+}
+
+UploadManager::Batch UploadManager::acquireBatch() {
+    if (!m_freeBatches.empty()) {
+        const auto batch = m_freeBatches.back();
+        m_freeBatches.pop_back();
+
+        vkResetFences(m_engine.getLogicalDevice(), 1, &batch.fence);
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+
+        return batch;
+    }
+
+    const auto allocInfo = VkCommandBufferAllocateInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = m_commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    auto batch = Batch {};
+    const auto resultAllocateCommandBuffers = vkAllocateCommandBuffers(m_engine.getLogicalDevice(), &allocInfo, &batch.commandBuffer);
+    if (resultAllocateCommandBuffers != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    const auto fenceInfo = VkFenceCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    const auto resultCreateFence = vkCreateFence(m_engine.getLogicalDevice(), &fenceInfo, nullptr, &batch.fence);
+    if (resultCreateFence != VK_SUCCESS) {
+        vkFreeCommandBuffers(m_engine.getLogicalDevice(), m_commandPool, 1, &batch.commandBuffer);
+        throw std::runtime_error("failed to create upload fence!");
+    }
+
+    return batch;
+}
+
+void UploadManager::retireCompletedBatches() {
+    // Batches are submitted to a single queue, so they complete in order.
+    while (!m_submittedBatches.empty()) {
+        const auto& batch = m_submittedBatches.front();
+        if (vkGetFenceStatus(m_engine.getLogicalDevice(), batch.fence) != VK_SUCCESS) {
+            break;
+        }
+
+        this->retireBatch(batch);
+        m_submittedBatches.pop_front();
+    }
+}
+
+void UploadManager::retireOldestBatch() {
+    const auto& batch = m_submittedBatches.front();
+    vkWaitForFences(m_engine.getLogicalDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+
+    this->retireBatch(batch);
+    m_submittedBatches.pop_front();
+}
+
+void UploadManager::retireBatch(Batch batch) {
+    m_ringTail = batch.ringEnd;
+    m_completedTicket = batch.ticket;
+    m_freeBatches.push_back(batch);
+}
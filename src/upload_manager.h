@@ -0,0 +1,97 @@
+#ifndef _UPLOAD_MANAGER_H
+#define _UPLOAD_MANAGER_H
+
+#include <vulkan/vulkan.h>
+
+#include "engine.h"
+#include "memory_allocator.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Identifies one submitted batch of uploads. Tickets increase monotonically, so waiting for a ticket
+// also waits for every batch submitted before it.
+using UploadTicket = uint64_t;
+
+// Streams data into device local buffers through one persistently mapped staging ring buffer.
+//
+// `upload` copies the data into the ring and records a buffer copy, and `flush` submits every copy
+// recorded since the last flush as one batch, guarded by a fence, without waiting for it. A region of
+// the ring is reused only once the fence of the batch that read from it has signaled, so the host
+// blocks only when the ring is full, and then only on the oldest batch. Uploads larger than the ring
+// are streamed through it in pieces.
+//
+// Batches run on the engine's transfer queue. When that is the graphics queue, every batch ends with a
+// barrier that makes the copied data visible to later shader and vertex input reads on the same queue.
+// A dedicated transfer queue is not ordered against the other queues at all, so work that reads the
+// uploaded data has to wait for the batch's ticket first.
+class UploadManager final {
+    public:
+        explicit UploadManager(Engine& engine);
+        explicit UploadManager(Engine& engine, VkDeviceSize ringSize);
+
+        ~UploadManager();
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager& operator=(const UploadManager&) = delete;
+
+        void upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+        UploadTicket flush();
+
+        bool isComplete(UploadTicket ticket);
+
+        void wait(UploadTicket ticket);
+
+        void waitIdle();
+
+        VkDeviceSize getRingSize() const;
+
+        static constexpr VkDeviceSize DEFAULT_RING_SIZE = 16 * 1024 * 1024;
+        static constexpr VkDeviceSize COPY_ALIGNMENT = 16;
+    private:
+        struct Batch final {
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VkFence fence = VK_NULL_HANDLE;
+            UploadTicket ticket = 0;
+            // The ring position just past the last byte this batch reads.
+            uint64_t ringEnd = 0;
+        };
+
+        Engine& m_engine;
+        VkQueue m_queue;
+        VkCommandPool m_commandPool;
+        bool m_isDedicatedTransferQueue;
+        VkDeviceSize m_ringSize;
+        VkBuffer m_stagingBuffer;
+        MemoryAllocation m_stagingBufferMemory;
+        // Positions in the ring count bytes ever allocated, and wrap around modulo the ring size.
+        uint64_t m_ringHead;
+        uint64_t m_ringTail;
+        std::deque<Batch> m_submittedBatches;
+        std::vector<Batch> m_freeBatches;
+        Batch m_recordingBatch;
+        bool m_isRecording;
+        UploadTicket m_nextTicket;
+        UploadTicket m_completedTicket;
+
+        VkDeviceSize allocateRingRegion(VkDeviceSize size);
+
+        void beginRecording();
+
+        Batch acquireBatch();
+
+        void retireCompletedBatches();
+
+        void retireOldestBatch();
+
+        void retireBatch(Batch batch);
+};
+
+}
+
+#endif // _UPLOAD_MANAGER_H
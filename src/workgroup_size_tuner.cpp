@@ -0,0 +1,125 @@
+#include "workgroup_size_tuner.h"
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+
+using WorkgroupSizeTuner = VulkanEngine::WorkgroupSizeTuner;
+
+// Workgroups beyond this size only ever help kernels that share data through shared memory, which the
+// particle kernels do not.
+static constexpr uint32_t MAX_CANDIDATE_WORKGROUP_SIZE = 1024;
+
+WorkgroupSizeTuner::WorkgroupSizeTuner(VkPhysicalDevice physicalDevice, const std::filesystem::path& filePath)
+    : m_filePath { filePath }
+    , m_deviceUuid {}
+    , m_subgroupSize { 1 }
+    , m_maxWorkgroupSize { 1 }
+    , m_candidateSizes {}
+    , m_tunedSizes {}
+{
+    auto idProperties = VkPhysicalDeviceIDProperties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = nullptr,
+    };
+    auto subgroupProperties = VkPhysicalDeviceSubgroupProperties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES,
+        .pNext = &idProperties,
+    };
+    auto properties = VkPhysicalDeviceProperties2 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &subgroupProperties,
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    for (const uint8_t byte : idProperties.deviceUUID) {
+        m_deviceUuid += fmt::format("{:02x}", byte);
+    }
+
+    const auto& limits = properties.properties.limits;
+    m_subgroupSize = std::max(subgroupProperties.subgroupSize, 1u);
+    m_maxWorkgroupSize = std::min({
+        limits.maxComputeWorkGroupSize[0],
+        limits.maxComputeWorkGroupInvocations,
+        MAX_CANDIDATE_WORKGROUP_SIZE,
+    });
+
+    for (uint32_t size = std::min(m_subgroupSize, m_maxWorkgroupSize); size <= m_maxWorkgroupSize; size *= 2) {
+        m_candidateSizes.push_back(size);
+    }
+
+    this->load();
+}
+
+uint32_t WorkgroupSizeTuner::getSubgroupSize() const {
+    return m_subgroupSize;
+}
+
+uint32_t WorkgroupSizeTuner::getMaxWorkgroupSize() const {
+    return m_maxWorkgroupSize;
+}
+
+const std::vector<uint32_t>& WorkgroupSizeTuner::getCandidateSizes() const {
+    return m_candidateSizes;
+}
+
+std::optional<uint32_t> WorkgroupSizeTuner::getTunedSize(std::string_view kernelName) const {
+    const auto tunedSize = m_tunedSizes.find(std::make_pair(m_deviceUuid, std::string { kernelName }));
+    if (tunedSize == m_tunedSizes.end() || tunedSize->second == 0 || tunedSize->second > m_maxWorkgroupSize) {
+        return std::nullopt;
+    }
+
+    return tunedSize->second;
+}
+
+uint32_t WorkgroupSizeTuner::tune(std::string_view kernelName, const Benchmark& benchmark) {
+    uint32_t bestSize = m_candidateSizes.front();
+    auto bestTime = std::chrono::steady_clock::duration::max();
+    for (const uint32_t size : m_candidateSizes) {
+        const auto time = benchmark(size);
+        if (time < bestTime) {
+            bestSize = size;
+            bestTime = time;
+        }
+    }
+
+    m_tunedSizes.insert_or_assign(std::make_pair(m_deviceUuid, std::string { kernelName }), bestSize);
+
+    return bestSize;
+}
+
+void WorkgroupSizeTuner::save() const {
+    // Renamed over the file once it is written, so that a run starting up at the same time never reads
+    // half of it.
+    VulkanEngine::writeFileAtomically(m_filePath, "workgroup size file", [this](std::ofstream& file) {
+        for (const auto& [key, size] : m_tunedSizes) {
+            file << key.first << ' ' << key.second << ' ' << size << '\n';
+        }
+    });
+}
+
+void WorkgroupSizeTuner::load() {
+    auto file = std::ifstream { m_filePath };
+    if (!file.is_open()) {
+        return;
+    }
+
+    // Each line holds a device UUID, a kernel name, and a workgroup size. Anything else is skipped, and
+    // dropped the next time the file is saved.
+    auto line = std::string {};
+    while (std::getline(file, line)) {
+        auto fields = std::istringstream { line };
+        auto deviceUuid = std::string {};
+        auto kernelName = std::string {};
+        uint32_t size = 0;
+        if (fields >> deviceUuid >> kernelName >> size) {
+            m_tunedSizes.insert_or_assign(std::make_pair(deviceUuid, kernelName), size);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef _WORKGROUP_SIZE_TUNER_H
+#define _WORKGROUP_SIZE_TUNER_H
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace VulkanEngine {
+
+// Picks the workgroup size a compute kernel runs fastest with on a device. The fastest size differs
+// between vendors, and between software rasterizers and real GPUs, so the tuner times the kernel with
+// every candidate size once and remembers the winner in a file, keyed by the device UUID and the
+// kernel, so that later runs on the same device skip straight to it.
+//
+// The candidates are the subgroup size and its doublings up to the largest workgroup the device
+// supports in one dimension, since a workgroup that is not a whole number of subgroups leaves lanes idle.
+class WorkgroupSizeTuner final {
+    public:
+        using Benchmark = std::function<std::chrono::steady_clock::duration(uint32_t)>;
+
+        explicit WorkgroupSizeTuner(VkPhysicalDevice physicalDevice, const std::filesystem::path& filePath);
+
+        WorkgroupSizeTuner(const WorkgroupSizeTuner&) = delete;
+        WorkgroupSizeTuner& operator=(const WorkgroupSizeTuner&) = delete;
+
+        uint32_t getSubgroupSize() const;
+
+        uint32_t getMaxWorkgroupSize() const;
+
+        const std::vector<uint32_t>& getCandidateSizes() const;
+
+        // The size tuned for the kernel on this device by an earlier run, if any.
+        std::optional<uint32_t> getTunedSize(std::string_view kernelName) const;
+
+        // Times `benchmark` with every candidate size, and remembers the fastest for the kernel on this device
+        // until `save` writes it to the file.
+        uint32_t tune(std::string_view kernelName, const Benchmark& benchmark);
+
+        void save() const;
+    private:
+        std::filesystem::path m_filePath;
+        std::string m_deviceUuid;
+        uint32_t m_subgroupSize;
+        uint32_t m_maxWorkgroupSize;
+        std::vector<uint32_t> m_candidateSizes;
+        // The sizes of every device and kernel in the file, so that saving keeps the other devices' entries.
+        std::map<std::pair<std::string, std::string>, uint32_t> m_tunedSizes;
+
+        void load();
+};
+
+}
+
+#endif // _WORKGROUP_SIZE_TUNER_H